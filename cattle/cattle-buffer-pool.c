@@ -0,0 +1,399 @@
+/* Cattle - Brainfuck language toolkit
+ * Copyright (C) 2008-2020  Andrea Bolognani <eof@kiyuko.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Homepage: https://kiyuko.org/software/cattle
+ */
+
+#include "cattle-buffer-pool.h"
+#include "cattle-buffer-private.h"
+
+/**
+ * SECTION:cattle-buffer-pool
+ * @short_description: Pool of reusable memory buffers
+ *
+ * A #CattleBufferPool hands out #CattleBuffer objects and recycles
+ * them once they're no longer in use, so that code which needs a new
+ * buffer for every chunk of data, such as an input handler, doesn't
+ * have to create and finalize an object each time.
+ *
+ * Buffers are obtained using cattle_buffer_pool_acquire() and released
+ * using g_object_unref() as usual: as soon as the last reference held
+ * outside of the pool has been dropped, the buffer can be handed out
+ * again. Buffers keep the memory they have allocated when they're
+ * recycled, so after a while the pool contains buffers of the sizes
+ * that are commonly requested.
+ *
+ * The pool finds out when a buffer is no longer in use through a
+ * toggle reference, see g_object_add_toggle_ref(): as a consequence,
+ * buffers obtained from a pool should only be referenced and released
+ * from the thread the pool is used in.
+ */
+
+/**
+ * CattleBufferPool:
+ *
+ * Opaque data structure representing a pool of memory buffers. It
+ * should never be accessed directly.
+ */
+
+struct _CattleBufferPoolPrivate
+{
+    gboolean  disposed;
+
+    GSList   *entries;     /* Buffers owned by the pool */
+    guint     n_buffers;   /* Number of buffers owned by the pool */
+    guint     max_buffers; /* Maximum number of buffers to own */
+};
+
+/* A buffer owned by the pool, which only holds a toggle reference to
+ * it: the buffer is in use from the moment it's handed out until the
+ * toggle reference is the only one left */
+typedef struct
+{
+    CattleBuffer *buffer;
+    gboolean      in_use;
+} PoolEntry;
+
+G_DEFINE_TYPE_WITH_CODE (CattleBufferPool, cattle_buffer_pool, G_TYPE_OBJECT,
+                         G_ADD_PRIVATE (CattleBufferPool))
+
+/* Properties */
+enum
+{
+    PROP_0,
+    PROP_MAX_BUFFERS
+};
+
+#define DEFAULT_MAX_BUFFERS 4
+
+static void
+toggle_notify (gpointer  data,
+               GObject  *object G_GNUC_UNUSED,
+               gboolean  is_last_ref)
+{
+    PoolEntry *entry;
+
+    entry = (PoolEntry *) data;
+
+    /* The pool's reference is the only one left once the buffer's
+     * last user is done with it */
+    entry->in_use = !is_last_ref;
+}
+
+static PoolEntry*
+entry_new (CattleBuffer *buffer)
+{
+    PoolEntry *entry;
+
+    entry = g_new (PoolEntry, 1);
+    entry->buffer = buffer;
+    entry->in_use = FALSE;
+
+    g_object_add_toggle_ref (G_OBJECT (buffer), toggle_notify, entry);
+
+    return entry;
+}
+
+static void
+entry_free (PoolEntry *entry)
+{
+    g_object_remove_toggle_ref (G_OBJECT (entry->buffer), toggle_notify, entry);
+    g_free (entry);
+}
+
+static void
+cattle_buffer_pool_init (CattleBufferPool *self)
+{
+    CattleBufferPoolPrivate *priv;
+
+    priv = cattle_buffer_pool_get_instance_private (self);
+
+    priv->entries = NULL;
+    priv->n_buffers = 0;
+    priv->max_buffers = DEFAULT_MAX_BUFFERS;
+
+    priv->disposed = FALSE;
+
+    self->priv = priv;
+}
+
+static void
+cattle_buffer_pool_dispose (GObject *object)
+{
+    CattleBufferPool        *self;
+    CattleBufferPoolPrivate *priv;
+
+    self = CATTLE_BUFFER_POOL (object);
+    priv = self->priv;
+
+    g_return_if_fail (!priv->disposed);
+
+    /* Buffers still in use outside of the pool stay alive */
+    g_slist_free_full (priv->entries, (GDestroyNotify) entry_free);
+    priv->entries = NULL;
+    priv->n_buffers = 0;
+
+    priv->disposed = TRUE;
+
+    G_OBJECT_CLASS (cattle_buffer_pool_parent_class)->dispose (object);
+}
+
+static void
+cattle_buffer_pool_finalize (GObject *object)
+{
+    G_OBJECT_CLASS (cattle_buffer_pool_parent_class)->finalize (object);
+}
+
+/**
+ * cattle_buffer_pool_new:
+ *
+ * Create and initialize a new pool of memory buffers.
+ *
+ * Returns: (transfer full): a new #CattleBufferPool
+ */
+CattleBufferPool*
+cattle_buffer_pool_new (void)
+{
+    return g_object_new (CATTLE_TYPE_BUFFER_POOL, NULL);
+}
+
+/**
+ * cattle_buffer_pool_acquire:
+ * @pool: a #CattleBufferPool
+ * @size: number of bytes the buffer should be able to hold
+ *
+ * Get an empty memory buffer from @pool.
+ *
+ * The buffer's mode is %CATTLE_BUFFER_MODE_GROWABLE and its size is
+ * zero, but up to @size bytes can be added to it using
+ * cattle_buffer_append() without any memory being allocated.
+ *
+ * When all buffers owned by @pool are in use and no more can be
+ * created, a buffer that doesn't belong to @pool is returned instead.
+ *
+ * Returns: (transfer full): an empty #CattleBuffer
+ */
+CattleBuffer*
+cattle_buffer_pool_acquire (CattleBufferPool *self,
+                            gulong            size)
+{
+    CattleBufferPoolPrivate *priv;
+    CattleBuffer            *buffer;
+    PoolEntry               *entry;
+    PoolEntry               *candidate;
+    GSList                  *iter;
+
+    g_return_val_if_fail (CATTLE_IS_BUFFER_POOL (self), NULL);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, NULL);
+
+    entry = NULL;
+
+    /* Look for a buffer that's not in use, preferring one that's
+     * already large enough */
+    for (iter = priv->entries; iter != NULL; iter = iter->next)
+    {
+        candidate = (PoolEntry *) iter->data;
+
+        if (candidate->in_use)
+        {
+            continue;
+        }
+
+        entry = candidate;
+
+        if (_cattle_buffer_get_capacity (candidate->buffer) >= size)
+        {
+            break;
+        }
+    }
+
+    if (entry != NULL)
+    {
+        buffer = g_object_ref (entry->buffer);
+        entry->in_use = TRUE;
+
+        cattle_buffer_clear (buffer);
+        _cattle_buffer_reserve (buffer, size);
+
+        return buffer;
+    }
+
+    buffer = cattle_buffer_new_with_mode (CATTLE_BUFFER_MODE_GROWABLE, 0);
+    _cattle_buffer_reserve (buffer, size);
+
+    /* Keep the new buffer around for later, if there's room. The
+     * reference obtained when creating it goes to the caller */
+    if (priv->n_buffers < priv->max_buffers)
+    {
+        entry = entry_new (buffer);
+        entry->in_use = TRUE;
+
+        priv->entries = g_slist_prepend (priv->entries, entry);
+        priv->n_buffers++;
+    }
+
+    return buffer;
+}
+
+/**
+ * cattle_buffer_pool_set_max_buffers:
+ * @pool: a #CattleBufferPool
+ * @max_buffers: maximum number of buffers
+ *
+ * Set the maximum number of buffers @pool keeps around for reuse.
+ *
+ * Buffers owned by @pool in excess of the new maximum are released
+ * as soon as they're not in use.
+ */
+void
+cattle_buffer_pool_set_max_buffers (CattleBufferPool *self,
+                                    guint             max_buffers)
+{
+    CattleBufferPoolPrivate *priv;
+    GSList                  *iter;
+    GSList                  *next;
+
+    g_return_if_fail (CATTLE_IS_BUFFER_POOL (self));
+
+    priv = self->priv;
+    g_return_if_fail (!priv->disposed);
+
+    priv->max_buffers = max_buffers;
+
+    /* Drop the pool's reference to the extra buffers; those still in
+     * use will be finalized once their users are done with them */
+    for (iter = priv->entries; iter != NULL && priv->n_buffers > max_buffers; iter = next)
+    {
+        next = iter->next;
+
+        entry_free ((PoolEntry *) iter->data);
+        priv->entries = g_slist_delete_link (priv->entries, iter);
+        priv->n_buffers--;
+    }
+}
+
+/**
+ * cattle_buffer_pool_get_max_buffers:
+ * @pool: a #CattleBufferPool
+ *
+ * Get the maximum number of buffers @pool keeps around for reuse.
+ *
+ * Returns: the maximum number of buffers
+ */
+guint
+cattle_buffer_pool_get_max_buffers (CattleBufferPool *self)
+{
+    CattleBufferPoolPrivate *priv;
+
+    g_return_val_if_fail (CATTLE_IS_BUFFER_POOL (self), 0);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, 0);
+
+    return priv->max_buffers;
+}
+
+static void
+cattle_buffer_pool_set_property (GObject      *object,
+                                 guint         property_id,
+                                 const GValue *value,
+                                 GParamSpec   *pspec)
+{
+    CattleBufferPool *self;
+    guint             v_uint;
+
+    self = CATTLE_BUFFER_POOL (object);
+
+    switch (property_id)
+    {
+        case PROP_MAX_BUFFERS:
+
+            v_uint = g_value_get_uint (value);
+            cattle_buffer_pool_set_max_buffers (self, v_uint);
+
+            break;
+
+        default:
+
+            G_OBJECT_WARN_INVALID_PROPERTY_ID (object,
+                                               property_id,
+                                               pspec);
+
+            break;
+    }
+}
+
+static void
+cattle_buffer_pool_get_property (GObject    *object,
+                                 guint       property_id,
+                                 GValue     *value,
+                                 GParamSpec *pspec)
+{
+    CattleBufferPool *self;
+    guint             v_uint;
+
+    self = CATTLE_BUFFER_POOL (object);
+
+    switch (property_id)
+    {
+        case PROP_MAX_BUFFERS:
+
+            v_uint = cattle_buffer_pool_get_max_buffers (self);
+            g_value_set_uint (value, v_uint);
+
+            break;
+
+        default:
+
+            G_OBJECT_WARN_INVALID_PROPERTY_ID (object,
+                                               property_id,
+                                               pspec);
+
+            break;
+    }
+}
+
+static void
+cattle_buffer_pool_class_init (CattleBufferPoolClass *self)
+{
+    GObjectClass *object_class;
+    GParamSpec   *pspec;
+
+    object_class = G_OBJECT_CLASS (self);
+
+    object_class->set_property = cattle_buffer_pool_set_property;
+    object_class->get_property = cattle_buffer_pool_get_property;
+    object_class->dispose = cattle_buffer_pool_dispose;
+    object_class->finalize = cattle_buffer_pool_finalize;
+
+    /**
+     * CattleBufferPool:max-buffers:
+     *
+     * Maximum number of buffers kept around for reuse.
+     */
+    pspec = g_param_spec_uint ("max-buffers",
+                               "Maximum number of buffers",
+                               "Get/set maximum number of buffers",
+                               0,
+                               G_MAXUINT,
+                               DEFAULT_MAX_BUFFERS,
+                               G_PARAM_READWRITE);
+    g_object_class_install_property (object_class,
+                                     PROP_MAX_BUFFERS,
+                                     pspec);
+}
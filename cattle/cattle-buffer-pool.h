@@ -0,0 +1,68 @@
+/* Cattle - Brainfuck language toolkit
+ * Copyright (C) 2008-2020  Andrea Bolognani <eof@kiyuko.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Homepage: https://kiyuko.org/software/cattle
+ */
+
+#if !defined (__CATTLE_H_INSIDE__) && !defined (CATTLE_COMPILATION)
+#error "Only <cattle/cattle.h> can be included directly."
+#endif
+
+#ifndef __CATTLE_BUFFER_POOL_H__
+#define __CATTLE_BUFFER_POOL_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include <cattle/cattle-buffer.h>
+
+G_BEGIN_DECLS
+
+#define CATTLE_TYPE_BUFFER_POOL              (cattle_buffer_pool_get_type ())
+#define CATTLE_BUFFER_POOL(object)           (G_TYPE_CHECK_INSTANCE_CAST ((object), CATTLE_TYPE_BUFFER_POOL, CattleBufferPool))
+#define CATTLE_BUFFER_POOL_CLASS(klass)      (G_TYPE_CHECK_CLASS_CAST ((klass), CATTLE_TYPE_BUFFER_POOL, CattleBufferPoolClass))
+#define CATTLE_IS_BUFFER_POOL(object)        (G_TYPE_CHECK_INSTANCE_TYPE ((object), CATTLE_TYPE_BUFFER_POOL))
+#define CATTLE_IS_BUFFER_POOL_CLASS(klass)   (G_TYPE_CHECK_CLASS_TYPE ((klass), CATTLE_TYPE_BUFFER_POOL))
+#define CATTLE_BUFFER_POOL_GET_CLASS(object) (G_TYPE_INSTANCE_GET_CLASS ((object), CATTLE_TYPE_BUFFER_POOL, CattleBufferPoolClass))
+
+typedef struct _CattleBufferPool        CattleBufferPool;
+typedef struct _CattleBufferPoolClass   CattleBufferPoolClass;
+typedef struct _CattleBufferPoolPrivate CattleBufferPoolPrivate;
+
+struct _CattleBufferPool
+{
+    GObject parent;
+    CattleBufferPoolPrivate *priv;
+};
+
+struct _CattleBufferPoolClass
+{
+    GObjectClass parent;
+};
+
+CattleBufferPool* cattle_buffer_pool_new             (void);
+CattleBuffer*     cattle_buffer_pool_acquire         (CattleBufferPool *pool,
+                                                      gulong            size);
+void              cattle_buffer_pool_set_max_buffers (CattleBufferPool *pool,
+                                                      guint             max_buffers);
+guint             cattle_buffer_pool_get_max_buffers (CattleBufferPool *pool);
+
+GType             cattle_buffer_pool_get_type        (void) G_GNUC_CONST;
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (CattleBufferPool, g_object_unref)
+
+G_END_DECLS
+
+#endif /* __CATTLE_BUFFER_POOL_H__ */
@@ -0,0 +1,53 @@
+/* Cattle - Brainfuck language toolkit
+ * Copyright (C) 2008-2020  Andrea Bolognani <eof@kiyuko.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Homepage: https://kiyuko.org/software/cattle
+ */
+
+#if !defined (CATTLE_COMPILATION)
+#error "This header is private to Cattle and can't be included directly."
+#endif
+
+#ifndef __CATTLE_BUFFER_PRIVATE_H__
+#define __CATTLE_BUFFER_PRIVATE_H__
+
+#include "cattle-buffer.h"
+
+G_BEGIN_DECLS
+
+/* Direct, read-only access to the contents of a buffer, for code that
+ * needs to scan all of them. The pointer is only valid until the
+ * buffer is modified or finalized */
+const gint8* _cattle_buffer_peek_contents (CattleBuffer *buffer);
+
+/* Number of bytes a buffer can hold without allocating more memory,
+ * and a way to make sure a growable buffer can hold at least @capacity
+ * bytes. Used by #CattleBufferPool */
+gulong       _cattle_buffer_get_capacity  (CattleBuffer *buffer);
+void         _cattle_buffer_reserve       (CattleBuffer *buffer,
+                                           gulong        capacity);
+
+/* Direct access to the memory of a growable buffer, up to its
+ * capacity, so that data can be read straight into it. Once the data
+ * is in place, _cattle_buffer_set_size() makes it part of the buffer's
+ * contents */
+gint8*       _cattle_buffer_peek_writable (CattleBuffer *buffer);
+void         _cattle_buffer_set_size      (CattleBuffer *buffer,
+                                           gulong        size);
+
+G_END_DECLS
+
+#endif /* __CATTLE_BUFFER_PRIVATE_H__ */
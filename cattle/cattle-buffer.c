@@ -17,13 +17,47 @@
  * Homepage: https://kiyuko.org/software/cattle
  */
 
+#include "cattle-enums.h"
 #include "cattle-buffer.h"
+#include "cattle-buffer-private.h"
+#include "cattle-error.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
 
 /**
  * SECTION:cattle-buffer
  * @short_description: Memory buffer
  *
  * A #CattleBuffer represents a memory buffer.
+ *
+ * Buffers created using cattle_buffer_new() allocate their own storage.
+ * cattle_buffer_new_from_bytes() and cattle_buffer_new_with_free_func()
+ * can be used instead to wrap memory that already contains the data,
+ * such as the contents of a file, without copying it: this avoids
+ * duplicating large programs or inputs before they are passed to
+ * cattle_program_load() or cattle_interpreter_feed().
+ *
+ * Wrapped memory is never modified: the first time the contents of
+ * such a buffer are changed, the buffer makes a private copy of them.
+ *
+ * cattle_buffer_new_from_file() maps the contents of a file into
+ * memory, so that only the parts of the file that are actually used
+ * are read from disk, and processes loading the same file share the
+ * same memory.
+ *
+ * cattle_buffer_new_slice() creates a buffer that refers to a range
+ * of another buffer instead of copying it; cattle_program_load() uses
+ * slices to extract the program's input from the code.
+ *
+ * By default the size of a buffer is fixed, but buffers created using
+ * cattle_buffer_new_with_mode() can also grow as data is appended to
+ * them using cattle_buffer_append(), or work as ring buffers: data is
+ * written to the buffer using cattle_buffer_write() and consumed, in
+ * the same order, using cattle_buffer_read(). Both make it possible
+ * for a producer to stream data through a single long-lived buffer
+ * instead of creating a new one for each chunk.
  */
 
 /**
@@ -33,12 +67,45 @@
  * be accessed directly.
  */
 
+/**
+ * CattleBufferMode:
+ * @CATTLE_BUFFER_MODE_FIXED: The size of the buffer never changes.
+ * This is the default mode
+ * @CATTLE_BUFFER_MODE_GROWABLE: The buffer grows when data is appended
+ * to it using cattle_buffer_append()
+ * @CATTLE_BUFFER_MODE_RING: The buffer works as a ring buffer with
+ * separate read and write cursors, see cattle_buffer_write() and
+ * cattle_buffer_read(). Its size is the number of bytes it can hold
+ *
+ * Possible ways for a #CattleBuffer to manage its contents.
+ */
+
 struct _CattleBufferPrivate
 {
-    gboolean  disposed;
-
-    gint8    *data;
-    gulong    size;
+    gboolean          disposed;
+
+    gint8            *data;
+    gulong            size;
+    CattleBufferMode  mode;
+
+    /* Growable buffers only: number of bytes allocated */
+    gulong            capacity;
+
+    /* Ring buffers only: position of the next byte to be read, and
+     * number of bytes that have been written but not read yet */
+    gulong            read_cursor;
+    gulong            available;
+
+    /* Set if @data points to memory the buffer doesn't own and,
+     * respectively, if that memory can't be modified in place */
+    gboolean          wrapped;
+    gboolean          read_only;
+    GDestroyNotify    free_func;
+    gpointer          user_data;
+
+    /* Set once slices of the buffer have been created: the memory
+     * they point to must stay valid until the buffer is finalized */
+    gboolean          sliced;
 };
 
 G_DEFINE_TYPE_WITH_CODE (CattleBuffer, cattle_buffer, G_TYPE_OBJECT,
@@ -47,7 +114,8 @@ G_DEFINE_TYPE_WITH_CODE (CattleBuffer, cattle_buffer, G_TYPE_OBJECT,
 /* Properties */
 enum {
     PROP_0,
-    PROP_SIZE
+    PROP_SIZE,
+    PROP_MODE
 };
 
 static void
@@ -59,6 +127,16 @@ cattle_buffer_init (CattleBuffer *self)
 
     priv->data = NULL;
     priv->size = 1;
+    priv->mode = CATTLE_BUFFER_MODE_FIXED;
+    priv->capacity = 0;
+    priv->read_cursor = 0;
+    priv->available = 0;
+
+    priv->wrapped = FALSE;
+    priv->read_only = FALSE;
+    priv->free_func = NULL;
+    priv->user_data = NULL;
+    priv->sliced = FALSE;
 
     priv->disposed = FALSE;
 
@@ -78,7 +156,16 @@ cattle_buffer_constructed (GObject *object)
 
     if (priv->size > 0)
     {
-        priv->data = (gint8 *) g_slice_alloc0 (priv->size);
+        /* Growable buffers need to be reallocated */
+        if (priv->mode == CATTLE_BUFFER_MODE_GROWABLE)
+        {
+            priv->data = (gint8 *) g_malloc0 (priv->size);
+            priv->capacity = priv->size;
+        }
+        else
+        {
+            priv->data = (gint8 *) g_slice_alloc0 (priv->size);
+        }
     }
 }
 
@@ -108,14 +195,83 @@ cattle_buffer_finalize (GObject *object)
     priv = self->priv;
 
     /* Free allocated data */
-    if (priv->data != NULL)
+    if (!priv->wrapped && priv->data != NULL)
     {
-        g_slice_free1 (priv->size, priv->data);
+        if (priv->mode == CATTLE_BUFFER_MODE_GROWABLE)
+        {
+            g_free (priv->data);
+        }
+        else
+        {
+            g_slice_free1 (priv->size, priv->data);
+        }
+    }
+
+    /* Let the owner of wrapped memory know it's no longer in use */
+    if (priv->free_func != NULL)
+    {
+        priv->free_func (priv->user_data);
     }
 
     G_OBJECT_CLASS (cattle_buffer_parent_class)->finalize (object);
 }
 
+/* Make sure the contents of a buffer can be modified, copying them
+ * if they're stored in read-only wrapped memory */
+static void
+make_writable (CattleBufferPrivate *priv)
+{
+    gint8 *data;
+
+    if (!priv->read_only)
+    {
+        return;
+    }
+
+    data = NULL;
+
+    if (priv->size > 0)
+    {
+        data = (gint8 *) g_slice_copy (priv->size, priv->data);
+    }
+
+    /* Slices might still be using the wrapped memory, in which case
+     * it will be released when the buffer is finalized */
+    if (!priv->sliced && priv->free_func != NULL)
+    {
+        priv->free_func (priv->user_data);
+        priv->free_func = NULL;
+        priv->user_data = NULL;
+    }
+
+    priv->data = data;
+    priv->wrapped = FALSE;
+    priv->read_only = FALSE;
+}
+
+/* Make sure a growable buffer has room for at least @capacity bytes */
+static void
+reserve (CattleBufferPrivate *priv,
+         gulong               capacity)
+{
+    gulong size;
+
+    if (capacity <= priv->capacity)
+    {
+        return;
+    }
+
+    /* Double the capacity every time the buffer fills up */
+    size = MAX (priv->capacity, 64);
+    while (size < capacity)
+    {
+        size = size > G_MAXULONG / 2 ? G_MAXULONG : size * 2;
+    }
+
+    priv->data = (gint8 *) g_realloc (priv->data, size);
+    priv->capacity = size;
+}
+
 /**
  * cattle_buffer_new:
  * @size: size of the buffer
@@ -133,6 +289,228 @@ cattle_buffer_new (gulong size)
                          NULL);
 }
 
+/**
+ * cattle_buffer_new_with_mode:
+ * @mode: a #CattleBufferMode
+ * @size: initial size of the buffer
+ *
+ * Create and initialize a new memory buffer that manages its contents
+ * according to @mode.
+ *
+ * For %CATTLE_BUFFER_MODE_RING buffers, @size is the maximum number
+ * of bytes that can be stored in the buffer at any given time.
+ *
+ * Returns: (transfer full): a new #CattleBuffer
+ */
+CattleBuffer*
+cattle_buffer_new_with_mode (CattleBufferMode mode,
+                             gulong           size)
+{
+    return g_object_new (CATTLE_TYPE_BUFFER,
+                         "mode",
+                         mode,
+                         "size",
+                         size,
+                         NULL);
+}
+
+/**
+ * cattle_buffer_new_with_free_func: (skip)
+ * @data: (transfer none): memory to wrap
+ * @size: size of @data
+ * @free_func: (nullable): function to call when @data is no longer
+ *             needed, or %NULL
+ * @user_data: data to pass to @free_func
+ *
+ * Create a new memory buffer whose contents are @data.
+ *
+ * @data is not copied, so it must stay valid until @free_func is
+ * called with @user_data as argument; this happens when the buffer is
+ * finalized, or when its contents are modified for the first time.
+ *
+ * Returns: (transfer full): a new #CattleBuffer
+ */
+CattleBuffer*
+cattle_buffer_new_with_free_func (gconstpointer  data,
+                                  gulong         size,
+                                  GDestroyNotify free_func,
+                                  gpointer       user_data)
+{
+    CattleBuffer        *self;
+    CattleBufferPrivate *priv;
+
+    g_return_val_if_fail (data != NULL || size == 0, NULL);
+
+    self = g_object_new (CATTLE_TYPE_BUFFER,
+                         "size",
+                         (gulong) 0,
+                         NULL);
+    priv = self->priv;
+
+    priv->data = (gint8 *) data;
+    priv->size = size;
+    priv->wrapped = TRUE;
+    priv->read_only = TRUE;
+    priv->free_func = free_func;
+    priv->user_data = user_data;
+
+    return self;
+}
+
+/**
+ * cattle_buffer_new_from_file:
+ * @filename: (type filename): path of the file to map
+ * @error: (allow-none): return location for a #GError
+ *
+ * Create a new memory buffer whose contents are the same as the
+ * contents of @filename.
+ *
+ * The file is mapped into memory rather than read, so creating the
+ * buffer is cheap regardless of the size of the file. The mapping is
+ * private: modifying the contents of the buffer doesn't change the
+ * file, and only copies the pages that are actually modified.
+ *
+ * In case of failure, @error is filled with detailed information.
+ * The error domain is %CATTLE_ERROR, and the error code is
+ * %CATTLE_ERROR_IO.
+ *
+ * Returns: (transfer full): a new #CattleBuffer, or %NULL
+ */
+CattleBuffer*
+cattle_buffer_new_from_file (const gchar  *filename,
+                             GError      **error)
+{
+    CattleBuffer *self;
+    GMappedFile  *file;
+    GError       *inner_error;
+    gint          fd;
+
+    g_return_val_if_fail (filename != NULL, NULL);
+    g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+    /* Only read access to the file is needed, because changes
+     * are never written back */
+    fd = open (filename, O_RDONLY);
+
+    if (fd < 0)
+    {
+        g_set_error (error,
+                     CATTLE_ERROR,
+                     CATTLE_ERROR_IO,
+                     "%s: %s",
+                     filename,
+                     strerror (errno));
+
+        return NULL;
+    }
+
+    inner_error = NULL;
+    file = g_mapped_file_new_from_fd (fd, TRUE, &inner_error);
+
+    close (fd);
+
+    if (file == NULL)
+    {
+        g_set_error_literal (error,
+                             CATTLE_ERROR,
+                             CATTLE_ERROR_IO,
+                             inner_error->message);
+        g_error_free (inner_error);
+
+        return NULL;
+    }
+
+    self = cattle_buffer_new_with_free_func (g_mapped_file_get_contents (file),
+                                             g_mapped_file_get_length (file),
+                                             (GDestroyNotify) g_mapped_file_unref,
+                                             file);
+
+    /* Writable mappings are copy-on-write, so there's no need for
+     * the buffer to make a copy of its own */
+    self->priv->read_only = FALSE;
+
+    return self;
+}
+
+/**
+ * cattle_buffer_new_from_bytes:
+ * @bytes: a #GBytes
+ *
+ * Create a new memory buffer whose contents are the same as @bytes.
+ *
+ * The data is not copied: the buffer keeps a reference to @bytes
+ * instead.
+ *
+ * Returns: (transfer full): a new #CattleBuffer
+ */
+CattleBuffer*
+cattle_buffer_new_from_bytes (GBytes *bytes)
+{
+    gconstpointer data;
+    gsize         size;
+
+    g_return_val_if_fail (bytes != NULL, NULL);
+
+    data = g_bytes_get_data (bytes, &size);
+
+    return cattle_buffer_new_with_free_func (data,
+                                             (gulong) size,
+                                             (GDestroyNotify) g_bytes_unref,
+                                             g_bytes_ref (bytes));
+}
+
+/**
+ * cattle_buffer_new_slice:
+ * @buffer: a #CattleBuffer
+ * @offset: offset of the first byte of the slice
+ * @size: size of the slice
+ *
+ * Create a new memory buffer whose contents are the @size bytes
+ * of @buffer starting at @offset.
+ *
+ * The contents are not copied: the slice keeps a reference to
+ * @buffer instead, which is why creating a slice takes the same time
+ * regardless of its size. Modifying the slice doesn't modify @buffer;
+ * changes made to @buffer after the slice has been created, on the
+ * other hand, may or may not be visible through the slice.
+ *
+ * The range described by @offset and @size must be entirely inside
+ * @buffer. Only buffers whose mode is %CATTLE_BUFFER_MODE_FIXED can be
+ * sliced.
+ *
+ * Returns: (transfer full): a new #CattleBuffer
+ */
+CattleBuffer*
+cattle_buffer_new_slice (CattleBuffer *buffer,
+                         gulong        offset,
+                         gulong        size)
+{
+    CattleBufferPrivate *priv;
+    gint8               *data;
+
+    g_return_val_if_fail (CATTLE_IS_BUFFER (buffer), NULL);
+
+    priv = buffer->priv;
+    g_return_val_if_fail (!priv->disposed, NULL);
+    g_return_val_if_fail (priv->mode == CATTLE_BUFFER_MODE_FIXED, NULL);
+    g_return_val_if_fail (offset <= priv->size, NULL);
+    g_return_val_if_fail (size <= priv->size - offset, NULL);
+
+    data = NULL;
+
+    if (size > 0)
+    {
+        data = priv->data + offset;
+    }
+
+    priv->sliced = TRUE;
+
+    return cattle_buffer_new_with_free_func (data,
+                                             size,
+                                             g_object_unref,
+                                             g_object_ref (buffer));
+}
+
 /**
  * cattle_buffer_set_contents: (skip)
  * @buffer: a #CattleBuffer
@@ -172,23 +550,88 @@ void
 cattle_buffer_set_contents_full (CattleBuffer *self,
                                  gint8        *contents,
                                  gulong        size)
+{
+    g_return_if_fail (CATTLE_IS_BUFFER (self));
+    g_return_if_fail (contents != NULL);
+
+    cattle_buffer_set_contents_at (self, 0, contents, size);
+}
+
+/**
+ * cattle_buffer_set_contents_at:
+ * @buffer: a #CattleBuffer
+ * @offset: offset inside the memory buffer
+ * @contents: (transfer none) (array length=size): data to copy inside
+ *            the memory buffer
+ * @size: size of @contents
+ *
+ * Set part of the contents of the memory buffer, starting at @offset.
+ *
+ * The range described by @offset and @size must be entirely inside
+ * the memory buffer.
+ */
+void
+cattle_buffer_set_contents_at (CattleBuffer *self,
+                               gulong        offset,
+                               const gint8  *contents,
+                               gulong        size)
 {
     CattleBufferPrivate *priv;
-    gulong               i;
 
     g_return_if_fail (CATTLE_IS_BUFFER (self));
-    g_return_if_fail (contents != NULL);
+    g_return_if_fail (contents != NULL || size == 0);
 
     priv = self->priv;
     g_return_if_fail (!priv->disposed);
+    g_return_if_fail (offset <= priv->size);
+    g_return_if_fail (size <= priv->size - offset);
 
-    g_return_if_fail (size <= priv->size);
+    if (size == 0)
+    {
+        return;
+    }
+
+    make_writable (priv);
 
-    /* Copy the data one byte at a time */
-    for (i = 0; i < size; i++)
+    memcpy (priv->data + offset, contents, size);
+}
+
+/**
+ * cattle_buffer_get_contents_at:
+ * @buffer: a #CattleBuffer
+ * @offset: offset inside the memory buffer
+ * @contents: (out caller-allocates) (array length=size): return location
+ *            for the data
+ * @size: number of bytes to copy
+ *
+ * Copy part of the contents of the memory buffer, starting at @offset,
+ * to @contents.
+ *
+ * The range described by @offset and @size must be entirely inside
+ * the memory buffer.
+ */
+void
+cattle_buffer_get_contents_at (CattleBuffer *self,
+                               gulong        offset,
+                               gint8        *contents,
+                               gulong        size)
+{
+    CattleBufferPrivate *priv;
+
+    g_return_if_fail (CATTLE_IS_BUFFER (self));
+    g_return_if_fail (contents != NULL || size == 0);
+
+    priv = self->priv;
+    g_return_if_fail (!priv->disposed);
+    g_return_if_fail (offset <= priv->size);
+    g_return_if_fail (size <= priv->size - offset);
+
+    if (size == 0)
     {
-        priv->data[i] = contents[i];
+        return;
     }
+
+    memcpy (contents, priv->data + offset, size);
 }
 
 /**
@@ -215,6 +658,8 @@ cattle_buffer_set_value (CattleBuffer *self,
     g_return_if_fail (!priv->disposed);
     g_return_if_fail (position < priv->size);
 
+    make_writable (priv);
+
     priv->data[position] = value;
 }
 
@@ -266,6 +711,310 @@ cattle_buffer_get_size (CattleBuffer *self)
     return priv->size;
 }
 
+/**
+ * cattle_buffer_get_mode:
+ * @buffer: a #CattleBuffer
+ *
+ * Get the way the memory buffer manages its contents.
+ *
+ * Returns: a #CattleBufferMode
+ */
+CattleBufferMode
+cattle_buffer_get_mode (CattleBuffer *self)
+{
+    CattleBufferPrivate *priv;
+
+    g_return_val_if_fail (CATTLE_IS_BUFFER (self), CATTLE_BUFFER_MODE_FIXED);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, CATTLE_BUFFER_MODE_FIXED);
+
+    return priv->mode;
+}
+
+/**
+ * cattle_buffer_append:
+ * @buffer: a #CattleBuffer
+ * @contents: (transfer none) (array length=size): data to append
+ * @size: size of @contents
+ *
+ * Append @contents to the end of the memory buffer, increasing its
+ * size accordingly.
+ *
+ * Only buffers whose mode is %CATTLE_BUFFER_MODE_GROWABLE can grow.
+ * Storage is allocated in increasingly large chunks, so appending
+ * small amounts of data repeatedly is cheap.
+ */
+void
+cattle_buffer_append (CattleBuffer *self,
+                      const gint8  *contents,
+                      gulong        size)
+{
+    CattleBufferPrivate *priv;
+
+    g_return_if_fail (CATTLE_IS_BUFFER (self));
+    g_return_if_fail (contents != NULL || size == 0);
+
+    priv = self->priv;
+    g_return_if_fail (!priv->disposed);
+    g_return_if_fail (priv->mode == CATTLE_BUFFER_MODE_GROWABLE);
+    g_return_if_fail (size <= G_MAXULONG - priv->size);
+
+    if (size == 0)
+    {
+        return;
+    }
+
+    reserve (priv, priv->size + size);
+
+    memcpy (priv->data + priv->size, contents, size);
+    priv->size += size;
+}
+
+/**
+ * cattle_buffer_write:
+ * @buffer: a #CattleBuffer
+ * @contents: (transfer none) (array length=size): data to write
+ * @size: size of @contents
+ *
+ * Write @contents to the memory buffer, after any data that has
+ * already been written but not read yet.
+ *
+ * Only buffers whose mode is %CATTLE_BUFFER_MODE_RING support this
+ * operation. If there is not enough room for @contents, only the
+ * bytes that fit are written.
+ *
+ * Returns: the number of bytes actually written
+ */
+gulong
+cattle_buffer_write (CattleBuffer *self,
+                     const gint8  *contents,
+                     gulong        size)
+{
+    CattleBufferPrivate *priv;
+    gulong               position;
+    gulong               length;
+
+    g_return_val_if_fail (CATTLE_IS_BUFFER (self), 0);
+    g_return_val_if_fail (contents != NULL || size == 0, 0);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, 0);
+    g_return_val_if_fail (priv->mode == CATTLE_BUFFER_MODE_RING, 0);
+
+    size = MIN (size, priv->size - priv->available);
+
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    /* The write cursor always follows the unread data. Data that
+     * doesn't fit before the end of the storage wraps around */
+    position = priv->read_cursor + priv->available;
+    if (position >= priv->size)
+    {
+        position -= priv->size;
+    }
+
+    length = MIN (size, priv->size - position);
+    memcpy (priv->data + position, contents, length);
+    memcpy (priv->data, contents + length, size - length);
+
+    priv->available += size;
+
+    return size;
+}
+
+/**
+ * cattle_buffer_read:
+ * @buffer: a #CattleBuffer
+ * @contents: (out caller-allocates) (array length=size): return location
+ *            for the data
+ * @size: maximum number of bytes to read
+ *
+ * Read data from the memory buffer, in the same order it has been
+ * written using cattle_buffer_write(). Data that has been read is
+ * removed from the buffer, making room for more.
+ *
+ * Only buffers whose mode is %CATTLE_BUFFER_MODE_RING support this
+ * operation.
+ *
+ * Returns: the number of bytes actually read, which is smaller than
+ *          @size if not enough data was available
+ */
+gulong
+cattle_buffer_read (CattleBuffer *self,
+                    gint8        *contents,
+                    gulong        size)
+{
+    CattleBufferPrivate *priv;
+    gulong               length;
+
+    g_return_val_if_fail (CATTLE_IS_BUFFER (self), 0);
+    g_return_val_if_fail (contents != NULL || size == 0, 0);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, 0);
+    g_return_val_if_fail (priv->mode == CATTLE_BUFFER_MODE_RING, 0);
+
+    size = MIN (size, priv->available);
+
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    length = MIN (size, priv->size - priv->read_cursor);
+    memcpy (contents, priv->data + priv->read_cursor, length);
+    memcpy (contents + length, priv->data, size - length);
+
+    priv->read_cursor += size;
+    if (priv->read_cursor >= priv->size)
+    {
+        priv->read_cursor -= priv->size;
+    }
+    priv->available -= size;
+
+    return size;
+}
+
+/**
+ * cattle_buffer_get_available:
+ * @buffer: a #CattleBuffer
+ *
+ * Get the number of bytes that have been written to the memory buffer
+ * using cattle_buffer_write() but have not been read yet.
+ *
+ * Only buffers whose mode is %CATTLE_BUFFER_MODE_RING support this
+ * operation.
+ *
+ * Returns: the number of bytes available for reading
+ */
+gulong
+cattle_buffer_get_available (CattleBuffer *self)
+{
+    CattleBufferPrivate *priv;
+
+    g_return_val_if_fail (CATTLE_IS_BUFFER (self), 0);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, 0);
+    g_return_val_if_fail (priv->mode == CATTLE_BUFFER_MODE_RING, 0);
+
+    return priv->available;
+}
+
+/**
+ * cattle_buffer_clear:
+ * @buffer: a #CattleBuffer
+ *
+ * Remove all data from the memory buffer, so that it can be reused.
+ *
+ * The size of a %CATTLE_BUFFER_MODE_GROWABLE buffer goes back to zero,
+ * but the memory allocated so far is kept around; a
+ * %CATTLE_BUFFER_MODE_RING buffer discards all data that has not been
+ * read yet. Buffers whose mode is %CATTLE_BUFFER_MODE_FIXED can't be
+ * cleared.
+ */
+void
+cattle_buffer_clear (CattleBuffer *self)
+{
+    CattleBufferPrivate *priv;
+
+    g_return_if_fail (CATTLE_IS_BUFFER (self));
+
+    priv = self->priv;
+    g_return_if_fail (!priv->disposed);
+    g_return_if_fail (priv->mode != CATTLE_BUFFER_MODE_FIXED);
+
+    if (priv->mode == CATTLE_BUFFER_MODE_GROWABLE)
+    {
+        priv->size = 0;
+    }
+    else
+    {
+        priv->read_cursor = 0;
+        priv->available = 0;
+    }
+}
+
+void
+_cattle_buffer_reserve (CattleBuffer *self,
+                        gulong        capacity)
+{
+    CattleBufferPrivate *priv;
+
+    g_return_if_fail (CATTLE_IS_BUFFER (self));
+
+    priv = self->priv;
+    g_return_if_fail (!priv->disposed);
+    g_return_if_fail (priv->mode == CATTLE_BUFFER_MODE_GROWABLE);
+
+    reserve (priv, capacity);
+}
+
+gulong
+_cattle_buffer_get_capacity (CattleBuffer *self)
+{
+    CattleBufferPrivate *priv;
+
+    g_return_val_if_fail (CATTLE_IS_BUFFER (self), 0);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, 0);
+
+    if (priv->mode == CATTLE_BUFFER_MODE_GROWABLE)
+    {
+        return priv->capacity;
+    }
+
+    return priv->size;
+}
+
+gint8*
+_cattle_buffer_peek_writable (CattleBuffer *self)
+{
+    CattleBufferPrivate *priv;
+
+    g_return_val_if_fail (CATTLE_IS_BUFFER (self), NULL);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, NULL);
+    g_return_val_if_fail (priv->mode == CATTLE_BUFFER_MODE_GROWABLE, NULL);
+
+    return priv->data;
+}
+
+void
+_cattle_buffer_set_size (CattleBuffer *self,
+                         gulong        size)
+{
+    CattleBufferPrivate *priv;
+
+    g_return_if_fail (CATTLE_IS_BUFFER (self));
+
+    priv = self->priv;
+    g_return_if_fail (!priv->disposed);
+    g_return_if_fail (priv->mode == CATTLE_BUFFER_MODE_GROWABLE);
+    g_return_if_fail (size <= priv->capacity);
+
+    priv->size = size;
+}
+
+const gint8*
+_cattle_buffer_peek_contents (CattleBuffer *self)
+{
+    CattleBufferPrivate *priv;
+
+    g_return_val_if_fail (CATTLE_IS_BUFFER (self), NULL);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, NULL);
+
+    return priv->data;
+}
+
 static void
 cattle_buffer_set_property (GObject      *object,
                             guint         property_id,
@@ -275,6 +1024,7 @@ cattle_buffer_set_property (GObject      *object,
     CattleBuffer        *self;
     CattleBufferPrivate *priv;
     gulong               v_ulong;
+    CattleBufferMode     v_mode;
 
     self = CATTLE_BUFFER (object);
     priv = self->priv;
@@ -290,6 +1040,13 @@ cattle_buffer_set_property (GObject      *object,
 
             break;
 
+        case PROP_MODE:
+
+            v_mode = g_value_get_enum (value);
+            priv->mode = v_mode;
+
+            break;
+
         default:
 
             G_OBJECT_WARN_INVALID_PROPERTY_ID (object,
@@ -306,8 +1063,9 @@ cattle_buffer_get_property (GObject    *object,
                             GValue     *value,
                             GParamSpec *pspec)
 {
-    CattleBuffer *self;
-    gulong        v_ulong;
+    CattleBuffer     *self;
+    gulong            v_ulong;
+    CattleBufferMode  v_mode;
 
     self = CATTLE_BUFFER (object);
 
@@ -320,6 +1078,13 @@ cattle_buffer_get_property (GObject    *object,
 
             break;
 
+        case PROP_MODE:
+
+            v_mode = cattle_buffer_get_mode (self);
+            g_value_set_enum (value, v_mode);
+
+            break;
+
         default:
 
             G_OBJECT_WARN_INVALID_PROPERTY_ID (object,
@@ -359,4 +1124,19 @@ cattle_buffer_class_init (CattleBufferClass *self)
     g_object_class_install_property (object_class,
                                      PROP_SIZE,
                                      pspec);
+
+    /**
+     * CattleBuffer:mode:
+     *
+     * Way the memory buffer manages its contents.
+     */
+    pspec = g_param_spec_enum ("mode",
+                               "Buffer mode",
+                               "Get buffer mode",
+                               CATTLE_TYPE_BUFFER_MODE,
+                               CATTLE_BUFFER_MODE_FIXED,
+                               G_PARAM_READWRITE|G_PARAM_CONSTRUCT_ONLY);
+    g_object_class_install_property (object_class,
+                                     PROP_MODE,
+                                     pspec);
 }
@@ -36,6 +36,13 @@ G_BEGIN_DECLS
 #define CATTLE_IS_BUFFER_CLASS(klass)   (G_TYPE_CHECK_CLASS_TYPE ((klass), CATTLE_TYPE_BUFFER))
 #define CATTLE_BUFFER_GET_CLASS(object) (G_TYPE_INSTANCE_GET_CLASS ((object), CATTLE_TYPE_BUFFER, CattleBufferClass))
 
+typedef enum
+{
+    CATTLE_BUFFER_MODE_FIXED,
+    CATTLE_BUFFER_MODE_GROWABLE,
+    CATTLE_BUFFER_MODE_RING
+} CattleBufferMode;
+
 typedef struct _CattleBuffer        CattleBuffer;
 typedef struct _CattleBufferClass   CattleBufferClass;
 typedef struct _CattleBufferPrivate CattleBufferPrivate;
@@ -51,20 +58,52 @@ struct _CattleBufferClass
     GObjectClass parent;
 };
 
-CattleBuffer* cattle_buffer_new               (gulong        size);
-void          cattle_buffer_set_contents      (CattleBuffer *buffer,
-                                               gint8        *contents);
-void          cattle_buffer_set_contents_full (CattleBuffer *buffer,
-                                               gint8        *contents,
-                                               gulong        size);
-void          cattle_buffer_set_value         (CattleBuffer *buffer,
-                                               gulong        position,
-                                               gint8         value);
-gint8         cattle_buffer_get_value         (CattleBuffer *buffer,
-                                               gulong        position);
-gulong        cattle_buffer_get_size          (CattleBuffer *buffer);
+CattleBuffer*    cattle_buffer_new                (gulong             size);
+CattleBuffer*    cattle_buffer_new_with_mode      (CattleBufferMode   mode,
+                                                   gulong             size);
+CattleBuffer*    cattle_buffer_new_with_free_func (gconstpointer      data,
+                                                   gulong             size,
+                                                   GDestroyNotify     free_func,
+                                                   gpointer           user_data);
+CattleBuffer*    cattle_buffer_new_from_bytes     (GBytes            *bytes);
+CattleBuffer*    cattle_buffer_new_from_file      (const gchar       *filename,
+                                                   GError           **error);
+CattleBuffer*    cattle_buffer_new_slice          (CattleBuffer      *buffer,
+                                                   gulong             offset,
+                                                   gulong             size);
+void             cattle_buffer_set_contents       (CattleBuffer      *buffer,
+                                                   gint8             *contents);
+void             cattle_buffer_set_contents_full  (CattleBuffer      *buffer,
+                                                   gint8             *contents,
+                                                   gulong             size);
+void             cattle_buffer_set_contents_at    (CattleBuffer      *buffer,
+                                                   gulong             offset,
+                                                   const gint8       *contents,
+                                                   gulong             size);
+void             cattle_buffer_get_contents_at    (CattleBuffer      *buffer,
+                                                   gulong             offset,
+                                                   gint8             *contents,
+                                                   gulong             size);
+void             cattle_buffer_set_value          (CattleBuffer      *buffer,
+                                                   gulong             position,
+                                                   gint8              value);
+gint8            cattle_buffer_get_value          (CattleBuffer      *buffer,
+                                                   gulong             position);
+gulong           cattle_buffer_get_size           (CattleBuffer      *buffer);
+CattleBufferMode cattle_buffer_get_mode           (CattleBuffer      *buffer);
+void             cattle_buffer_append             (CattleBuffer      *buffer,
+                                                   const gint8       *contents,
+                                                   gulong             size);
+gulong           cattle_buffer_write              (CattleBuffer      *buffer,
+                                                   const gint8       *contents,
+                                                   gulong             size);
+gulong           cattle_buffer_read               (CattleBuffer      *buffer,
+                                                   gint8             *contents,
+                                                   gulong             size);
+gulong           cattle_buffer_get_available      (CattleBuffer      *buffer);
+void             cattle_buffer_clear              (CattleBuffer      *buffer);
 
-GType         cattle_buffer_get_type          (void) G_GNUC_CONST;
+GType            cattle_buffer_get_type           (void) G_GNUC_CONST;
 
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (CattleBuffer, g_object_unref)
 
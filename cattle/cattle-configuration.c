@@ -52,6 +52,7 @@ struct _CattleConfigurationPrivate
 
     CattleEndOfInputAction end_of_input_action;
     gboolean               debug_is_enabled;
+    gboolean               cycle_detection_is_enabled;
 };
 
 G_DEFINE_TYPE_WITH_CODE (CattleConfiguration, cattle_configuration, G_TYPE_OBJECT,
@@ -62,7 +63,8 @@ enum
 {
     PROP_0,
     PROP_END_OF_INPUT_ACTION,
-    PROP_DEBUG_IS_ENABLED
+    PROP_DEBUG_IS_ENABLED,
+    PROP_CYCLE_DETECTION_IS_ENABLED
 };
 
 static void
@@ -74,6 +76,7 @@ cattle_configuration_init (CattleConfiguration *self)
 
     priv->end_of_input_action = CATTLE_END_OF_INPUT_ACTION_STORE_ZERO;
     priv->debug_is_enabled = FALSE;
+    priv->cycle_detection_is_enabled = FALSE;
 
     priv->disposed = FALSE;
 
@@ -219,6 +222,59 @@ cattle_configuration_get_debug_is_enabled (CattleConfiguration *self)
     return priv->debug_is_enabled;
 }
 
+/**
+ * cattle_configuration_set_cycle_detection_is_enabled:
+ * @configuration: a #CattleConfiguration
+ * @enabled: %TRUE to enable cycle detection, %FALSE otherwise
+ *
+ * Set the status of runtime cycle detection. It is disabled by default.
+ *
+ * Loops that provably never change the value of the current cell are
+ * always detected when the program is loaded, and running them results
+ * in a %CATTLE_ERROR_INFINITE_LOOP error.
+ *
+ * If cycle detection is enabled, the interpreter will additionally
+ * keep track of the state of the cells touched by small loops that
+ * perform no I/O, and report the same error as soon as one such loop
+ * goes back to a state it has already been in. Doing so has a
+ * noticeable cost, which is why this is not enabled by default.
+ */
+void
+cattle_configuration_set_cycle_detection_is_enabled (CattleConfiguration *self,
+                                                     gboolean             enabled)
+{
+    CattleConfigurationPrivate *priv;
+
+    g_return_if_fail (CATTLE_IS_CONFIGURATION (self));
+
+    priv = self->priv;
+    g_return_if_fail (!priv->disposed);
+
+    priv->cycle_detection_is_enabled = enabled;
+}
+
+/**
+ * cattle_configuration_get_cycle_detection_is_enabled:
+ * @configuration: a #CattleConfiguration
+ *
+ * Get the current status of runtime cycle detection.
+ * See cattle_configuration_set_cycle_detection_is_enabled().
+ *
+ * Returns: %TRUE if cycle detection is enabled, %FALSE otherwise
+ */
+gboolean
+cattle_configuration_get_cycle_detection_is_enabled (CattleConfiguration *self)
+{
+    CattleConfigurationPrivate *priv;
+
+    g_return_val_if_fail (CATTLE_IS_CONFIGURATION (self), FALSE);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, FALSE);
+
+    return priv->cycle_detection_is_enabled;
+}
+
 static void
 cattle_configuration_set_property (GObject      *object,
                                    guint         property_id,
@@ -249,6 +305,14 @@ cattle_configuration_set_property (GObject      *object,
 
             break;
 
+        case PROP_CYCLE_DETECTION_IS_ENABLED:
+
+            v_bool = g_value_get_boolean (value);
+            cattle_configuration_set_cycle_detection_is_enabled (self,
+                                                                 v_bool);
+
+            break;
+
         default:
 
             G_OBJECT_WARN_INVALID_PROPERTY_ID (object,
@@ -287,6 +351,13 @@ cattle_configuration_get_property (GObject    *object,
 
             break;
 
+        case PROP_CYCLE_DETECTION_IS_ENABLED:
+
+            v_bool = cattle_configuration_get_cycle_detection_is_enabled (self);
+            g_value_set_boolean (value, v_bool);
+
+            break;
+
         default:
 
             G_OBJECT_WARN_INVALID_PROPERTY_ID (object,
@@ -343,4 +414,22 @@ cattle_configuration_class_init (CattleConfigurationClass *self)
     g_object_class_install_property (object_class,
                                      PROP_DEBUG_IS_ENABLED,
                                      pspec);
+
+    /**
+     * CattleConfiguration:cycle-detection-is-enabled:
+     *
+     * If %TRUE, the interpreter looks for small loops going back to
+     * a state they have already been in, and stops them with a
+     * %CATTLE_ERROR_INFINITE_LOOP error.
+     *
+     * Changes to this property are not notified.
+     */
+    pspec = g_param_spec_boolean ("cycle-detection-is-enabled",
+                                  "Whether or not cycle detection is enabled",
+                                  "Get/set cycle detection support",
+                                  FALSE,
+                                  G_PARAM_READWRITE);
+    g_object_class_install_property (object_class,
+                                     PROP_CYCLE_DETECTION_IS_ENABLED,
+                                     pspec);
 }
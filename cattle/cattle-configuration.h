@@ -58,15 +58,18 @@ struct _CattleConfigurationClass
     GObjectClass parent;
 };
 
-CattleConfiguration*    cattle_configuration_new                     (void);
-void                    cattle_configuration_set_end_of_input_action (CattleConfiguration    *configuration,
-                                                                      CattleEndOfInputAction  action);
-CattleEndOfInputAction  cattle_configuration_get_end_of_input_action (CattleConfiguration    *configuration);
-void                    cattle_configuration_set_debug_is_enabled    (CattleConfiguration    *configuration,
-                                                                      gboolean                enabled);
-gboolean                cattle_configuration_get_debug_is_enabled    (CattleConfiguration    *configuration);
+CattleConfiguration*    cattle_configuration_new                            (void);
+void                    cattle_configuration_set_end_of_input_action        (CattleConfiguration    *configuration,
+                                                                             CattleEndOfInputAction  action);
+CattleEndOfInputAction  cattle_configuration_get_end_of_input_action        (CattleConfiguration    *configuration);
+void                    cattle_configuration_set_debug_is_enabled           (CattleConfiguration    *configuration,
+                                                                             gboolean                enabled);
+gboolean                cattle_configuration_get_debug_is_enabled           (CattleConfiguration    *configuration);
+void                    cattle_configuration_set_cycle_detection_is_enabled (CattleConfiguration    *configuration,
+                                                                             gboolean                enabled);
+gboolean                cattle_configuration_get_cycle_detection_is_enabled (CattleConfiguration    *configuration);
 
-GType                   cattle_configuration_get_type                (void) G_GNUC_CONST;
+GType                   cattle_configuration_get_type                       (void) G_GNUC_CONST;
 
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (CattleConfiguration, g_object_unref)
 
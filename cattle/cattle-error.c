@@ -37,6 +37,12 @@
  * brackets don't match
  * @CATTLE_ERROR_INPUT_OUT_OF_RANGE: The input cannot be stored in a
  * tape cell
+ * @CATTLE_ERROR_INFINITE_LOOP: A loop that can never terminate has
+ * been entered
+ * @CATTLE_ERROR_TAPE_OUT_OF_BOUNDS: The program tried to move past the
+ * edge of a tape that can't grow
+ * @CATTLE_ERROR_TAPE_MEMORY_LIMIT: The program tried to move to cells
+ * that would take a tape over its memory limit
  *
  * Errors detected either on code loading or at runtime.
  */
@@ -0,0 +1,120 @@
+/* Cattle - Brainfuck language toolkit
+ * Copyright (C) 2008-2020  Andrea Bolognani <eof@kiyuko.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Homepage: https://kiyuko.org/software/cattle
+ */
+
+#if !defined (CATTLE_COMPILATION)
+#error "This header is private to Cattle and can't be included directly."
+#endif
+
+#ifndef __CATTLE_INSTRUCTION_PRIVATE_H__
+#define __CATTLE_INSTRUCTION_PRIVATE_H__
+
+#include "cattle-instruction.h"
+
+G_BEGIN_DECLS
+
+/* Largest loop footprint, in cells, the interpreter is willing to
+ * track when looking for repeated states at runtime */
+#define CATTLE_LOOP_FOOTPRINT_MAX 16
+
+/* Information about a loop collected by the code loader.
+ * Instructions that have not been analyzed, or that have changed
+ * since, are always CATTLE_LOOP_KIND_GENERIC.
+ *
+ * Conditional loops are loops whose body always leaves the loop
+ * cell set to zero, and as such can run at most once: both the
+ * instruction starting the loop and the one ending it are marked,
+ * and the latter points back to the former */
+typedef enum
+{
+    CATTLE_LOOP_KIND_GENERIC,
+    CATTLE_LOOP_KIND_INFINITE,
+    CATTLE_LOOP_KIND_CONDITIONAL
+} CattleLoopKind;
+
+/* Loop information is collected by the code loader for a whole program
+ * at once, and only holds as long as none of the instructions it was
+ * collected from changes: all those instructions share a
+ * CattleAnalysis, which becomes stale as soon as one of them does */
+typedef struct _CattleAnalysis CattleAnalysis;
+
+struct _CattleAnalysis
+{
+    gint                    ref_count;
+    gboolean                stale;
+};
+
+/* Defined here, rather than in cattle-instruction.c, so that the fast
+ * path below can be inlined */
+struct _CattleInstructionPrivate
+{
+    gboolean                disposed;
+
+    CattleInstructionValue  value;
+    gulong                  quantity;
+
+    CattleInstruction      *next;
+    CattleInstruction      *loop;
+
+    CattleLoopKind          loop_kind;
+    gboolean                has_footprint;
+    glong                   footprint_lower;
+    glong                   footprint_upper;
+    CattleInstruction      *loop_begin; /* Weak pointer */
+    CattleAnalysis         *analysis;
+};
+
+CattleAnalysis*    _cattle_analysis_new                   (void);
+void               _cattle_analysis_unref                 (CattleAnalysis    *analysis);
+gboolean           _cattle_analysis_is_stale              (CattleAnalysis    *analysis);
+
+void               _cattle_instruction_set_analysis       (CattleInstruction *instruction,
+                                                           CattleAnalysis    *analysis);
+void               _cattle_instruction_set_loop_kind      (CattleInstruction *instruction,
+                                                           CattleLoopKind     kind);
+void               _cattle_instruction_set_loop_footprint (CattleInstruction *instruction,
+                                                           glong              lower,
+                                                           glong              upper);
+gboolean           _cattle_instruction_get_loop_footprint (CattleInstruction *instruction,
+                                                           glong             *lower,
+                                                           glong             *upper);
+void               _cattle_instruction_set_loop_begin     (CattleInstruction *instruction,
+                                                           CattleInstruction *begin);
+CattleInstruction* _cattle_instruction_get_loop_begin     (CattleInstruction *instruction);
+
+/* Kind of the loop started or ended by @instruction. The interpreter
+ * looks it up every time it reaches a loop, so it performs no checks
+ * at all */
+static inline CattleLoopKind
+_cattle_instruction_get_loop_kind (CattleInstruction *instruction)
+{
+    CattleInstructionPrivate *priv;
+
+    priv = instruction->priv;
+
+    if (G_UNLIKELY (priv->analysis == NULL || priv->analysis->stale))
+    {
+        return CATTLE_LOOP_KIND_GENERIC;
+    }
+
+    return priv->loop_kind;
+}
+
+G_END_DECLS
+
+#endif /* __CATTLE_INSTRUCTION_PRIVATE_H__ */
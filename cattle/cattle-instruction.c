@@ -19,6 +19,7 @@
 
 #include "cattle-enums.h"
 #include "cattle-instruction.h"
+#include "cattle-instruction-private.h"
 
 /**
  * SECTION:cattle-instruction
@@ -82,17 +83,6 @@
  * accessed directly.
  */
 
-struct _CattleInstructionPrivate
-{
-    gboolean                disposed;
-
-    CattleInstructionValue  value;
-    gulong                  quantity;
-
-    CattleInstruction      *next;
-    CattleInstruction      *loop;
-};
-
 G_DEFINE_TYPE_WITH_CODE (CattleInstruction, cattle_instruction, G_TYPE_OBJECT,
                          G_ADD_PRIVATE (CattleInstruction))
 
@@ -118,11 +108,62 @@ cattle_instruction_init (CattleInstruction *self)
     priv->next = NULL;
     priv->loop = NULL;
 
+    priv->loop_kind = CATTLE_LOOP_KIND_GENERIC;
+    priv->has_footprint = FALSE;
+    priv->footprint_lower = 0;
+    priv->footprint_upper = 0;
+    priv->loop_begin = NULL;
+    priv->analysis = NULL;
+
     priv->disposed = FALSE;
 
     self->priv = priv;
 }
 
+/* Called whenever @instruction changes: nothing that was known about
+ * the program it's part of can be trusted anymore */
+static void
+invalidate (CattleInstruction *self)
+{
+    CattleInstructionPrivate *priv;
+
+    priv = self->priv;
+
+    if (priv->analysis != NULL)
+    {
+        priv->analysis->stale = TRUE;
+    }
+}
+
+/* Whether the loop information stored in @instruction can be used */
+static gboolean
+is_analyzed (CattleInstruction *self)
+{
+    CattleInstructionPrivate *priv;
+
+    priv = self->priv;
+
+    return (priv->analysis != NULL && !priv->analysis->stale);
+}
+
+static void
+forget_loop (CattleInstruction *self)
+{
+    CattleInstructionPrivate *priv;
+
+    priv = self->priv;
+
+    priv->loop_kind = CATTLE_LOOP_KIND_GENERIC;
+    priv->has_footprint = FALSE;
+
+    if (priv->loop_begin != NULL)
+    {
+        g_object_remove_weak_pointer (G_OBJECT (priv->loop_begin),
+                                      (gpointer *) &priv->loop_begin);
+        priv->loop_begin = NULL;
+    }
+}
+
 static void
 cattle_instruction_dispose (GObject *object)
 {
@@ -134,6 +175,14 @@ cattle_instruction_dispose (GObject *object)
 
     g_return_if_fail (!priv->disposed);
 
+    forget_loop (self);
+
+    if (priv->analysis != NULL)
+    {
+        _cattle_analysis_unref (priv->analysis);
+        priv->analysis = NULL;
+    }
+
     if (priv->next != NULL)
     {
         g_object_unref (priv->next);
@@ -203,6 +252,10 @@ cattle_instruction_set_value (CattleInstruction      *self,
     g_return_if_fail (enum_value != NULL);
 
     priv->value = value;
+
+    /* Whatever was known about the loop no longer applies */
+    forget_loop (self);
+    invalidate (self);
 }
 
 /**
@@ -248,6 +301,8 @@ cattle_instruction_set_quantity (CattleInstruction *self,
     g_return_if_fail (!priv->disposed);
 
     priv->quantity = quantity;
+
+    invalidate (self);
 }
 
 /**
@@ -306,6 +361,8 @@ cattle_instruction_set_next (CattleInstruction *self,
     {
         g_object_ref (priv->next);
     }
+
+    invalidate (self);
 }
 
 /**
@@ -376,6 +433,10 @@ cattle_instruction_set_loop (CattleInstruction *self,
     {
         g_object_ref (priv->loop);
     }
+
+    /* Whatever was known about the loop no longer applies */
+    forget_loop (self);
+    invalidate (self);
 }
 
 /**
@@ -407,6 +468,164 @@ cattle_instruction_get_loop (CattleInstruction *self)
     return priv->loop;
 }
 
+CattleAnalysis*
+_cattle_analysis_new (void)
+{
+    CattleAnalysis *analysis;
+
+    analysis = g_new (CattleAnalysis, 1);
+    analysis->ref_count = 1;
+    analysis->stale = FALSE;
+
+    return analysis;
+}
+
+void
+_cattle_analysis_unref (CattleAnalysis *analysis)
+{
+    g_return_if_fail (analysis != NULL);
+
+    if (g_atomic_int_dec_and_test (&analysis->ref_count))
+    {
+        g_free (analysis);
+    }
+}
+
+/* Whether any of the instructions that are part of @analysis has
+ * changed since it was created */
+gboolean
+_cattle_analysis_is_stale (CattleAnalysis *analysis)
+{
+    g_return_val_if_fail (analysis != NULL, TRUE);
+
+    return analysis->stale;
+}
+
+/* Make @instruction part of @analysis, discarding the loop information
+ * collected by any previous one */
+void
+_cattle_instruction_set_analysis (CattleInstruction *self,
+                                  CattleAnalysis    *analysis)
+{
+    CattleInstructionPrivate *priv;
+
+    g_return_if_fail (CATTLE_IS_INSTRUCTION (self));
+    g_return_if_fail (analysis != NULL);
+
+    priv = self->priv;
+    g_return_if_fail (!priv->disposed);
+
+    forget_loop (self);
+
+    g_atomic_int_inc (&analysis->ref_count);
+    if (priv->analysis != NULL)
+    {
+        _cattle_analysis_unref (priv->analysis);
+    }
+    priv->analysis = analysis;
+}
+
+/* Set the kind of the loop started by @instruction, as determined by
+ * the code loader */
+void
+_cattle_instruction_set_loop_kind (CattleInstruction *self,
+                                   CattleLoopKind     kind)
+{
+    CattleInstructionPrivate *priv;
+
+    g_return_if_fail (CATTLE_IS_INSTRUCTION (self));
+
+    priv = self->priv;
+    g_return_if_fail (!priv->disposed);
+
+    priv->loop_kind = kind;
+}
+
+/* Record that every iteration of the loop started by @instruction
+ * only accesses cells between @lower and @upper, relative to the
+ * loop cell, performs no I/O and ends at the loop cell */
+void
+_cattle_instruction_set_loop_footprint (CattleInstruction *self,
+                                        glong              lower,
+                                        glong              upper)
+{
+    CattleInstructionPrivate *priv;
+
+    g_return_if_fail (CATTLE_IS_INSTRUCTION (self));
+    g_return_if_fail (lower <= 0 && upper >= 0);
+    g_return_if_fail (upper - lower < CATTLE_LOOP_FOOTPRINT_MAX);
+
+    priv = self->priv;
+    g_return_if_fail (!priv->disposed);
+
+    priv->has_footprint = TRUE;
+    priv->footprint_lower = lower;
+    priv->footprint_upper = upper;
+}
+
+gboolean
+_cattle_instruction_get_loop_footprint (CattleInstruction *self,
+                                        glong             *lower,
+                                        glong             *upper)
+{
+    CattleInstructionPrivate *priv;
+
+    g_return_val_if_fail (CATTLE_IS_INSTRUCTION (self), FALSE);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, FALSE);
+
+    if (!priv->has_footprint || !is_analyzed (self))
+    {
+        return FALSE;
+    }
+
+    *lower = priv->footprint_lower;
+    *upper = priv->footprint_upper;
+
+    return TRUE;
+}
+
+/* Record the instruction that started the loop @instruction ends.
+ * Only a weak pointer is kept, since @begin already holds a reference
+ * to @instruction through the loop's body */
+void
+_cattle_instruction_set_loop_begin (CattleInstruction *self,
+                                    CattleInstruction *begin)
+{
+    CattleInstructionPrivate *priv;
+
+    g_return_if_fail (CATTLE_IS_INSTRUCTION (self));
+    g_return_if_fail (CATTLE_IS_INSTRUCTION (begin));
+
+    priv = self->priv;
+    g_return_if_fail (!priv->disposed);
+
+    if (priv->loop_begin != NULL)
+    {
+        g_object_remove_weak_pointer (G_OBJECT (priv->loop_begin),
+                                      (gpointer *) &priv->loop_begin);
+    }
+
+    priv->loop_begin = begin;
+    g_object_add_weak_pointer (G_OBJECT (priv->loop_begin),
+                               (gpointer *) &priv->loop_begin);
+}
+
+/* Returns: (transfer none) */
+CattleInstruction*
+_cattle_instruction_get_loop_begin (CattleInstruction *self)
+{
+    CattleInstructionPrivate *priv;
+
+    g_return_val_if_fail (CATTLE_IS_INSTRUCTION (self), NULL);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, NULL);
+
+    return priv->loop_begin;
+}
+
 static void
 cattle_instruction_set_property (GObject      *object,
                                  guint         property_id,
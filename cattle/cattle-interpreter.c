@@ -21,6 +21,10 @@
 #include "cattle-error.h"
 #include "cattle-constants.h"
 #include "cattle-interpreter.h"
+#include "cattle-buffer-pool.h"
+#include "cattle-buffer-private.h"
+#include "cattle-instruction-private.h"
+#include "cattle-tape-private.h"
 #include <unistd.h>
 #include <stdio.h>
 #include <string.h>
@@ -44,6 +48,13 @@
  * Once initialized, a #CattleInterpreter can run the assigned program
  * as many times as needed; the memory tape, however, is not
  * automatically cleared between executions.
+ *
+ * Input and output are always performed one byte at a time. If the
+ * cells of the memory tape are wider than 8 bits, see
+ * cattle_tape_new_with_cell_width(), bytes read from input are stored
+ * without sign extension and only the lowest 8 bits of a cell are
+ * written to output; the end of input, as signaled by %CATTLE_EOF, can
+ * then be told apart from a byte with the same value.
  */
 
 /**
@@ -55,30 +66,44 @@
 
 struct _CattleInterpreterPrivate
 {
-    gboolean             disposed;
-
-    CattleConfiguration *configuration;
-    CattleProgram       *program;
-    CattleTape          *tape;
-
-    CattleInputHandler   input_handler;
-    gpointer             input_handler_data;
-    CattleOutputHandler  output_handler;
-    gpointer             output_handler_data;
-    CattleDebugHandler   debug_handler;
-    gpointer             debug_handler_data;
-
-    GSList              *stack; /* Instruction stack */
-
-    gboolean             had_input;
-    CattleBuffer        *input;
-    gulong               input_offset;
-    gboolean             end_of_input_reached;
+    gboolean                disposed;
+
+    CattleConfiguration    *configuration;
+    CattleProgram          *program;
+    CattleTape             *tape;
+
+    CattleInputHandler      input_handler;
+    gpointer                input_handler_data;
+    CattleOutputHandler     output_handler;
+    gpointer                output_handler_data;
+    CattleBulkOutputHandler bulk_output_handler;
+    gpointer                bulk_output_handler_data;
+    CattleDebugHandler      debug_handler;
+    gpointer                debug_handler_data;
+
+    GSList                 *stack; /* Instruction stack */
+    GHashTable             *trackers; /* Cycle detection state */
+
+    gboolean                had_input;
+    CattleBuffer           *input;
+    gulong                  input_offset;
+    gboolean                end_of_input_reached;
+
+    CattleBufferPool       *pool; /* Buffers for the default input
+                                   * handler, created on first use */
 };
 
 G_DEFINE_TYPE_WITH_CODE (CattleInterpreter, cattle_interpreter, G_TYPE_OBJECT,
                          G_ADD_PRIVATE (CattleInterpreter))
 
+/* State of a loop being checked for cycles */
+typedef struct
+{
+    gulong power;
+    gulong length;
+    gint64 saved[CATTLE_LOOP_FOOTPRINT_MAX];
+} CycleTracker;
+
 /* Properties */
 enum
 {
@@ -89,18 +114,21 @@ enum
 };
 
 /* Internal functions */
-static gboolean run                    (CattleInterpreter  *interpreter,
-                                        GError            **error);
-static gboolean default_input_handler  (CattleInterpreter  *interpreter,
-                                        gpointer            data,
-                                        GError            **error);
-static gboolean default_output_handler (CattleInterpreter  *interpreter,
-                                        gint8               output,
-                                        gpointer            data,
-                                        GError            **error);
-static gboolean default_debug_handler  (CattleInterpreter  *interpreter,
-                                        gpointer            data,
-                                        GError            **error);
+static gboolean run                         (CattleInterpreter  *interpreter,
+                                             GError            **error);
+static gboolean default_input_handler       (CattleInterpreter  *interpreter,
+                                             gpointer            data,
+                                             GError            **error);
+static gboolean default_bulk_output_handler (CattleInterpreter  *interpreter,
+                                             gint8               output,
+                                             gulong              count,
+                                             gpointer            data,
+                                             GError            **error);
+static gboolean default_debug_handler       (CattleInterpreter  *interpreter,
+                                             gpointer            data,
+                                             GError            **error);
+static gboolean check_cycle                 (CattleInterpreter  *interpreter,
+                                             CattleInstruction  *loop);
 
 static void
 cattle_interpreter_init (CattleInterpreter *self)
@@ -115,16 +143,21 @@ cattle_interpreter_init (CattleInterpreter *self)
     self->priv->input_handler_data = NULL;
     self->priv->output_handler = NULL;
     self->priv->output_handler_data = NULL;
+    self->priv->bulk_output_handler = NULL;
+    self->priv->bulk_output_handler_data = NULL;
     self->priv->debug_handler = NULL;
     self->priv->debug_handler_data = NULL;
 
     self->priv->stack = NULL;
+    self->priv->trackers = NULL;
 
     self->priv->had_input = FALSE;
     self->priv->input = NULL;
     self->priv->input_offset = 0;
     self->priv->end_of_input_reached = FALSE;
 
+    self->priv->pool = NULL;
+
     self->priv->disposed = FALSE;
 }
 
@@ -144,6 +177,8 @@ cattle_interpreter_dispose (GObject *object)
     g_object_unref (self->priv->tape);
     self->priv->tape = NULL;
 
+    g_clear_object (&self->priv->pool);
+
     self->priv->disposed = TRUE;
 
     G_OBJECT_CLASS (cattle_interpreter_parent_class)->dispose (object);
@@ -155,9 +190,43 @@ cattle_interpreter_finalize (GObject *object)
     G_OBJECT_CLASS (cattle_interpreter_parent_class)->finalize (object);
 }
 
+/* Retrieve the next value from the current input buffer, if any is
+ * left. Ring buffers are consumed, so that input handlers can keep
+ * writing to the same buffer; other buffers are walked through */
 static gboolean
-run (CattleInterpreter  *self,
-     GError            **error)
+next_input (CattleInterpreterPrivate *priv,
+            gint8                    *value)
+{
+    if (cattle_buffer_get_mode (priv->input) == CATTLE_BUFFER_MODE_RING)
+    {
+        return (cattle_buffer_read (priv->input, value, 1) == 1);
+    }
+
+    if (priv->input_offset < cattle_buffer_get_size (priv->input))
+    {
+        *value = cattle_buffer_get_value (priv->input,
+                                          priv->input_offset);
+        priv->input_offset++;
+
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/* The main loop is specialized for each cell width: since @width is
+ * a constant in every copy, cell accesses don't need to look at it
+ * at runtime */
+#if defined (__GNUC__)
+#define ALWAYS_INLINE inline __attribute__ ((__always_inline__))
+#else
+#define ALWAYS_INLINE inline
+#endif
+
+static ALWAYS_INLINE gboolean
+run_with_width (CattleInterpreter  *self,
+                CattleCellWidth     width,
+                GError            **error)
 {
     CattleInterpreterPrivate *priv;
     CattleConfiguration      *configuration;
@@ -167,15 +236,17 @@ run (CattleInterpreter  *self,
     CattleInstruction        *current;
     CattleInstruction        *next;
     CattleInstructionValue    value;
+    CattleLoopKind            kind;
     CattleInputHandler        input_handler;
     CattleOutputHandler       output_handler;
+    CattleBulkOutputHandler   bulk_output_handler;
     CattleDebugHandler        debug_handler;
     GSList                   *stack;
     GError                   *inner_error;
     gboolean                  success;
+    gboolean                  eof;
     gint8                     temp;
     gulong                    quantity;
-    gulong                    size;
     gulong                    i;
 
     priv = self->priv;
@@ -190,9 +261,10 @@ run (CattleInterpreter  *self,
         input_handler = default_input_handler;
     }
     output_handler = priv->output_handler;
-    if (output_handler == NULL)
+    bulk_output_handler = priv->bulk_output_handler;
+    if (bulk_output_handler == NULL && output_handler == NULL)
     {
-        output_handler = default_output_handler;
+        bulk_output_handler = default_bulk_output_handler;
     }
     debug_handler = priv->debug_handler;
     if (debug_handler == NULL)
@@ -216,12 +288,38 @@ run (CattleInterpreter  *self,
         {
             case CATTLE_INSTRUCTION_LOOP_BEGIN:
 
-                next = cattle_instruction_get_loop (current);
-
                 /* Enter the loop only if the value stored in the
                  * current cell is not zero */
-                if (cattle_tape_get_current_value (tape) != 0)
+                if (_cattle_cell_get (_cattle_tape_peek_current_cell (tape), width) != 0)
                 {
+                    kind = _cattle_instruction_get_loop_kind (current);
+
+                    /* The loop was found to never change the value
+                     * of the current cell: it would run forever */
+                    if (G_UNLIKELY (kind == CATTLE_LOOP_KIND_INFINITE))
+                    {
+                        g_set_error_literal (error,
+                                             CATTLE_ERROR,
+                                             CATTLE_ERROR_INFINITE_LOOP,
+                                             "Infinite loop");
+
+                        g_object_unref (current);
+
+                        return FALSE;
+                    }
+
+                    next = cattle_instruction_get_loop (current);
+
+                    /* The loop runs at most once, so there's no need
+                     * to remember where it started */
+                    if (kind == CATTLE_LOOP_KIND_CONDITIONAL)
+                    {
+                        g_object_unref (current);
+                        current = next;
+
+                        continue;
+                    }
+
                     /* Push the current instruction on the stack */
                     stack = g_slist_prepend (stack, current);
                     priv->stack = stack;
@@ -234,6 +332,18 @@ run (CattleInterpreter  *self,
 
             case CATTLE_INSTRUCTION_LOOP_END:
 
+                /* End of a loop that runs at most once: move on to
+                 * the instruction following it */
+                if (_cattle_instruction_get_loop_kind (current) == CATTLE_LOOP_KIND_CONDITIONAL)
+                {
+                    next = _cattle_instruction_get_loop_begin (current);
+                    next = cattle_instruction_get_next (next);
+                    g_object_unref (current);
+                    current = next;
+
+                    continue;
+                }
+
                 /* If the instruction stack is empty, we're not running
                  * a loop, so trying to exit it is an error */
                 if (G_UNLIKELY (stack == NULL))
@@ -248,39 +358,118 @@ run (CattleInterpreter  *self,
                     return FALSE;
                 }
 
-                /* Pop an instruction off the stack */
                 g_object_unref (current);
+
+                /* Peek at the instruction that started the loop */
                 current = CATTLE_INSTRUCTION (stack->data);
+
+                if (_cattle_cell_get (_cattle_tape_peek_current_cell (tape), width) != 0)
+                {
+                    /* Make sure the loop is not going around in
+                     * circles before starting another iteration */
+                    if (G_UNLIKELY (priv->trackers != NULL) &&
+                        check_cycle (self, current))
+                    {
+                        g_set_error_literal (error,
+                                             CATTLE_ERROR,
+                                             CATTLE_ERROR_INFINITE_LOOP,
+                                             "Infinite loop");
+
+                        return FALSE;
+                    }
+
+                    /* Jump back to the first instruction in the loop */
+                    current = cattle_instruction_get_loop (current);
+
+                    continue;
+                }
+
+                /* Exit the loop, popping the instruction that started
+                 * it off the stack */
+                if (G_UNLIKELY (priv->trackers != NULL))
+                {
+                    g_hash_table_remove (priv->trackers, current);
+                }
                 stack = g_slist_delete_link (stack, stack);
                 priv->stack = stack;
 
-                continue;
+                break;
 
             case CATTLE_INSTRUCTION_MOVE_LEFT:
 
                 quantity = cattle_instruction_get_quantity (current);
-                cattle_tape_move_left_by (tape, quantity);
+
+                /* Only fails for tapes that can't grow, or can't grow
+                 * any further because of their memory limit */
+                if (G_UNLIKELY (!_cattle_tape_move_left_by (tape, quantity)))
+                {
+                    if (_cattle_tape_get_memory_limit_reached (tape))
+                    {
+                        g_set_error_literal (error,
+                                             CATTLE_ERROR,
+                                             CATTLE_ERROR_TAPE_MEMORY_LIMIT,
+                                             "Tape memory limit reached");
+                    }
+                    else
+                    {
+                        g_set_error_literal (error,
+                                             CATTLE_ERROR,
+                                             CATTLE_ERROR_TAPE_OUT_OF_BOUNDS,
+                                             "Tape out of bounds");
+                    }
+
+                    g_object_unref (current);
+
+                    return FALSE;
+                }
 
                 break;
 
             case CATTLE_INSTRUCTION_MOVE_RIGHT:
 
                 quantity = cattle_instruction_get_quantity (current);
-                cattle_tape_move_right_by (tape, quantity);
+
+                /* Only fails for tapes that can't grow, or can't grow
+                 * any further because of their memory limit */
+                if (G_UNLIKELY (!_cattle_tape_move_right_by (tape, quantity)))
+                {
+                    if (_cattle_tape_get_memory_limit_reached (tape))
+                    {
+                        g_set_error_literal (error,
+                                             CATTLE_ERROR,
+                                             CATTLE_ERROR_TAPE_MEMORY_LIMIT,
+                                             "Tape memory limit reached");
+                    }
+                    else
+                    {
+                        g_set_error_literal (error,
+                                             CATTLE_ERROR,
+                                             CATTLE_ERROR_TAPE_OUT_OF_BOUNDS,
+                                             "Tape out of bounds");
+                    }
+
+                    g_object_unref (current);
+
+                    return FALSE;
+                }
 
                 break;
 
             case CATTLE_INSTRUCTION_INCREASE:
 
                 quantity = cattle_instruction_get_quantity (current);
-                cattle_tape_increase_current_value_by (tape, quantity);
+                _cattle_cell_add (_cattle_tape_get_current_cell (tape),
+                                  quantity,
+                                  width);
 
                 break;
 
             case CATTLE_INSTRUCTION_DECREASE:
 
                 quantity = cattle_instruction_get_quantity (current);
-                cattle_tape_decrease_current_value_by (tape, quantity);
+                _cattle_cell_add (_cattle_tape_get_current_cell (tape),
+                                  -(guint64) quantity,
+                                  width);
 
                 break;
 
@@ -302,17 +491,9 @@ run (CattleInterpreter  *self,
                     }
                     else
                     {
-                        size = cattle_buffer_get_size (priv->input);
-
-                        if (priv->input_offset < size)
-                        {
-                            /* Current input buffer not consumed.
-                             * Get a value from the buffer and move forward */
-                            temp = cattle_buffer_get_value (priv->input,
-                                                            priv->input_offset);
-                            priv->input_offset++;
-                        }
-                        else
+                        /* Get a value from the current input buffer,
+                         * if it has not been consumed yet */
+                        if (!next_input (priv, &temp))
                         {
                             /* Current input buffer consumed */
 
@@ -359,17 +540,8 @@ run (CattleInterpreter  *self,
                                     return FALSE;
                                 }
 
-                                /* Update size of the input buffer */
-                                size = cattle_buffer_get_size (priv->input);
-
-                                if (priv->input_offset < size)
-                                {
-                                    /* Some input was retrieved */
-                                    temp = cattle_buffer_get_value (priv->input,
-                                                                    priv->input_offset);
-                                    priv->input_offset++;
-                                }
-                                else
+                                /* Retrieve some of the new input, if any */
+                                if (!next_input (priv, &temp))
                                 {
                                     /* No more available input */
                                     temp = CATTLE_EOF;
@@ -383,7 +555,16 @@ run (CattleInterpreter  *self,
                 /* Save the value. Executed only once even when multiple subsequent
                  * read instruction are present in the program */
 
-                if (temp == CATTLE_EOF)
+                /* The last read hit the end of input. With 8 bits wide
+                 * cells, there's no way to tell CATTLE_EOF apart from
+                 * a byte with the same value */
+                eof = priv->end_of_input_reached;
+                if (width == CATTLE_CELL_WIDTH_8)
+                {
+                    eof = (temp == CATTLE_EOF);
+                }
+
+                if (eof)
                 {
                     /* End of input.
                      * The new value depends on the configuration */
@@ -391,7 +572,9 @@ run (CattleInterpreter  *self,
                     {
                         case CATTLE_END_OF_INPUT_ACTION_STORE_EOF:
 
-                            cattle_tape_set_current_value (tape, temp);
+                            _cattle_cell_set (_cattle_tape_get_current_cell (tape),
+                                              CATTLE_EOF,
+                                              width);
                             break;
 
                         case CATTLE_END_OF_INPUT_ACTION_DO_NOTHING:
@@ -402,15 +585,20 @@ run (CattleInterpreter  *self,
                         case CATTLE_END_OF_INPUT_ACTION_STORE_ZERO:
                         default:
 
-                            cattle_tape_set_current_value (tape, 0);
+                            _cattle_cell_set (_cattle_tape_get_current_cell (tape),
+                                              0,
+                                              width);
                             break;
                     }
                 }
                 else
                 {
                     /* Not end of input.
-                     * Save the new value */
-                    cattle_tape_set_current_value (tape, temp);
+                     * Save the new value: bytes are not sign-extended
+                     * when stored in wider cells */
+                    _cattle_cell_set (_cattle_tape_get_current_cell (tape),
+                                      (guint8) temp,
+                                      width);
                 }
 
                 break;
@@ -419,42 +607,62 @@ run (CattleInterpreter  *self,
 
                 quantity = cattle_instruction_get_quantity (current);
 
+                /* Only the lowest 8 bits of wider cells are written */
+                temp = (gint8) _cattle_cell_get (_cattle_tape_peek_current_cell (tape),
+                                                  width);
+
                 /* Write the value in the current cell to standard
-                 * output */
-                for (i = 0; i < quantity; i++)
+                 * output. Bulk output handlers get all the copies
+                 * at once */
+                if (bulk_output_handler != NULL)
                 {
                     inner_error = NULL;
-                    success = (*output_handler) (self,
-                                                 cattle_tape_get_current_value (tape),
-                                                 priv->output_handler_data,
-                                                 &inner_error);
+                    success = (*bulk_output_handler) (self,
+                                                      temp,
+                                                      quantity,
+                                                      priv->bulk_output_handler_data,
+                                                      &inner_error);
                     success &= (inner_error == NULL);
+                }
+                else
+                {
+                    success = TRUE;
 
                     /* Stop at the first error, even if we should
                      * output the content of the current cell more
                      * than once */
-                    if (G_UNLIKELY (success == FALSE))
+                    for (i = 0; i < quantity && success; i++)
                     {
-                        /* If the signal handler has set the error,
-                         * propagate it; otherwise, raise a generic
-                         * I/O error */
-                        if (inner_error == NULL)
-                        {
-                            g_set_error_literal (error,
-                                                 CATTLE_ERROR,
-                                                 CATTLE_ERROR_IO,
-                                                 "Unknown I/O error");
-                        }
-                        else
-                        {
-                            g_propagate_error (error,
-                                               inner_error);
-                        }
-
-                        g_object_unref (current);
+                        inner_error = NULL;
+                        success = (*output_handler) (self,
+                                                     temp,
+                                                     priv->output_handler_data,
+                                                     &inner_error);
+                        success &= (inner_error == NULL);
+                    }
+                }
 
-                        return FALSE;
+                if (G_UNLIKELY (success == FALSE))
+                {
+                    /* If the signal handler has set the error,
+                     * propagate it; otherwise, raise a generic
+                     * I/O error */
+                    if (inner_error == NULL)
+                    {
+                        g_set_error_literal (error,
+                                             CATTLE_ERROR,
+                                             CATTLE_ERROR_IO,
+                                             "Unknown I/O error");
                     }
+                    else
+                    {
+                        g_propagate_error (error,
+                                           inner_error);
+                    }
+
+                    g_object_unref (current);
+
+                    return FALSE;
                 }
 
                 break;
@@ -530,6 +738,24 @@ run (CattleInterpreter  *self,
     return TRUE;
 }
 
+static gboolean
+run (CattleInterpreter  *self,
+     GError            **error)
+{
+    switch (cattle_tape_get_cell_width (self->priv->tape))
+    {
+        case CATTLE_CELL_WIDTH_16:
+            return run_with_width (self, CATTLE_CELL_WIDTH_16, error);
+        case CATTLE_CELL_WIDTH_32:
+            return run_with_width (self, CATTLE_CELL_WIDTH_32, error);
+        case CATTLE_CELL_WIDTH_64:
+            return run_with_width (self, CATTLE_CELL_WIDTH_64, error);
+        case CATTLE_CELL_WIDTH_8:
+        default:
+            return run_with_width (self, CATTLE_CELL_WIDTH_8, error);
+    }
+}
+
 /**
  * cattle_interpreter_new:
  *
@@ -559,6 +785,8 @@ cattle_interpreter_run (CattleInterpreter  *self,
     CattleInterpreterPrivate *priv;
     CattleProgram            *program;
     gboolean                  success;
+    glong                     lower;
+    glong                     upper;
 
     g_return_val_if_fail (CATTLE_IS_INTERPRETER (self), FALSE);
     g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
@@ -583,9 +811,25 @@ cattle_interpreter_run (CattleInterpreter  *self,
     priv->input_offset = 0;
     priv->end_of_input_reached = FALSE;
 
+    /* Setup tape: if the part of the tape the program can reach is
+     * known, allocate it all up front */
+    if (cattle_program_get_tape_extent (program, &lower, &upper))
+    {
+        cattle_tape_reserve (priv->tape, (gulong) -lower, (gulong) upper);
+    }
+
     /* Setup stack */
     priv->stack = NULL;
 
+    /* Setup cycle detection */
+    if (cattle_configuration_get_cycle_detection_is_enabled (priv->configuration))
+    {
+        priv->trackers = g_hash_table_new_full (g_direct_hash,
+                                                g_direct_equal,
+                                                NULL,
+                                                g_free);
+    }
+
     /* Run program */
     success = run (self, error);
 
@@ -595,6 +839,13 @@ cattle_interpreter_run (CattleInterpreter  *self,
         g_slist_free (priv->stack);
     }
 
+    /* Cleanup cycle detection */
+    if (priv->trackers != NULL)
+    {
+        g_hash_table_unref (priv->trackers);
+        priv->trackers = NULL;
+    }
+
     /* Cleanup input */
     g_object_unref (priv->input);
 
@@ -611,6 +862,15 @@ cattle_interpreter_run (CattleInterpreter  *self,
  * This method is meant to be used inside an input handler assigned to
  * @interpreter; calling it in any other context is pointless, since the
  * input is reset each time cattle_interpreter_run() is called.
+ *
+ * The contents of @input are not copied, so feeding @interpreter a
+ * buffer created with cattle_buffer_new_from_bytes() or
+ * cattle_buffer_new_with_free_func() avoids copying the data at all.
+ *
+ * If @input is a %CATTLE_BUFFER_MODE_RING buffer, @interpreter consumes
+ * it using cattle_buffer_read(): the input handler can then write more
+ * data to the same buffer using cattle_buffer_write(), rather than
+ * feeding @interpreter a new buffer every time it's invoked.
  */
 void
 cattle_interpreter_feed (CattleInterpreter *self,
@@ -625,11 +885,12 @@ cattle_interpreter_feed (CattleInterpreter *self,
 
     g_return_if_fail (!priv->disposed);
 
-    /* Release the previous input buffer */
+    /* Release the previous input buffer. The same buffer might be
+     * fed more than once, so acquire a reference to it first */
+    g_object_ref (input);
     g_object_unref (priv->input);
 
     priv->input = input;
-    g_object_ref (priv->input);
 
     priv->input_offset = 0;
     priv->end_of_input_reached = FALSE;
@@ -863,6 +1124,10 @@ cattle_interpreter_set_input_handler (CattleInterpreter  *self,
  * The handler will be invoked every time @interpreter needs to perform
  * an output action; if @handler is %NULL, the default output handler will
  * be used.
+ *
+ * If a bulk output handler has also been set using
+ * cattle_interpreter_set_bulk_output_handler(), that handler will be
+ * used instead.
  */
 void
 cattle_interpreter_set_output_handler (CattleInterpreter   *self,
@@ -881,6 +1146,54 @@ cattle_interpreter_set_output_handler (CattleInterpreter   *self,
     priv->output_handler_data = user_data;
 }
 
+/**
+ * CattleBulkOutputHandler:
+ * @interpreter: a #CattleInterpreter
+ * @output: a #gchar to output
+ * @count: number of times @output should be output
+ * @data: user data passed to the handler
+ * @error: return location for a #GError
+ *
+ * Handler for an output operation that outputs the same value several
+ * times in a row.
+ *
+ * Returns: %TRUE on success, %FALSE otherwise
+ */
+
+/**
+ * cattle_interpreter_set_bulk_output_handler:
+ * @interpreter: a #CattleInterpreter
+ * @handler: (scope notified) (allow-none): bulk output handler, or %NULL
+ * @user_data: (allow-none): user data for @handler
+ *
+ * Set the bulk output handler for @interpreter.
+ *
+ * The handler will be invoked every time @interpreter needs to perform
+ * an output action, with the number of copies of the value to output;
+ * this allows programs that repeatedly output the same value to do so
+ * with a single call.
+ *
+ * A bulk output handler takes precedence over the handler set using
+ * cattle_interpreter_set_output_handler(). If neither handler is set,
+ * the default output handler will be used.
+ */
+void
+cattle_interpreter_set_bulk_output_handler (CattleInterpreter       *self,
+                                            CattleBulkOutputHandler  handler,
+                                            gpointer                 user_data)
+{
+    CattleInterpreterPrivate *priv;
+
+    g_return_if_fail (CATTLE_IS_INTERPRETER (self));
+
+    priv = self->priv;
+
+    g_return_if_fail (!priv->disposed);
+
+    priv->bulk_output_handler = handler;
+    priv->bulk_output_handler_data = user_data;
+}
+
 /**
  * CattleDebugHandler:
  * @interpreter: a #CattleInterpreter
@@ -926,11 +1239,22 @@ default_input_handler (CattleInterpreter  *self,
                        gpointer            data G_GNUC_UNUSED,
                        GError            **error)
 {
-    CattleBuffer *input;
-    gint8         buffer[256];
-    gssize        size;
+    CattleInterpreterPrivate *priv;
+    CattleBuffer             *input;
+    gssize                    size;
+
+    priv = self->priv;
 
-    size = read (0, buffer, 256);
+    /* Buffers are recycled once the interpreter is done with them,
+     * so reading doesn't require creating a new object every time */
+    if (priv->pool == NULL)
+    {
+        priv->pool = cattle_buffer_pool_new ();
+    }
+
+    /* Read straight into the buffer's memory */
+    input = cattle_buffer_pool_acquire (priv->pool, 256);
+    size = read (0, _cattle_buffer_peek_writable (input), 256);
 
     if (size < 0)
     {
@@ -939,12 +1263,12 @@ default_input_handler (CattleInterpreter  *self,
                      CATTLE_ERROR_IO,
                      strerror (errno));
 
+        g_object_unref (input);
+
         return FALSE;
     }
 
-    /* Copy the contents to a buffer */
-    input = cattle_buffer_new ((gulong) size);
-    cattle_buffer_set_contents (input, (gint8 *) buffer);
+    _cattle_buffer_set_size (input, (gulong) size);
 
     /* Feed the buffer to the interpreter */
     cattle_interpreter_feed (self, input);
@@ -955,22 +1279,33 @@ default_input_handler (CattleInterpreter  *self,
 }
 
 static gboolean
-default_output_handler (CattleInterpreter  *self G_GNUC_UNUSED,
-                        gint8               output,
-                        gpointer            data G_GNUC_UNUSED,
-                        GError            **error)
+default_bulk_output_handler (CattleInterpreter  *self G_GNUC_UNUSED,
+                             gint8               output,
+                             gulong              count,
+                             gpointer            data G_GNUC_UNUSED,
+                             GError            **error)
 {
-    gint8 buffer[1];
+    gint8  buffer[256];
+    gssize size;
 
-    buffer[0] = output;
+    memset (buffer, output, MIN (count, 256));
 
-    if (G_UNLIKELY (write (1, buffer, 1) < 0))
+    /* Write the value in chunks, so that long runs only require
+     * a handful of system calls */
+    while (count > 0)
     {
-        g_set_error_literal (error,
-                             CATTLE_ERROR,
-                             CATTLE_ERROR_IO,
-                             strerror (errno));
-        return FALSE;
+        size = write (1, buffer, MIN (count, 256));
+
+        if (G_UNLIKELY (size < 0))
+        {
+            g_set_error_literal (error,
+                                 CATTLE_ERROR,
+                                 CATTLE_ERROR_IO,
+                                 strerror (errno));
+            return FALSE;
+        }
+
+        count -= (gulong) size;
     }
 
     return TRUE;
@@ -981,178 +1316,188 @@ default_debug_handler (CattleInterpreter  *self,
                        gpointer            data G_GNUC_UNUSED,
                        GError            **error)
 {
-    CattleTape *tape;
-    gint8       buffer[4];
-    gint8       value;
-    gulong      size;
-    gulong      steps;
+    CattleTape        *tape;
+    CattleTapePrivate *priv;
+    GString           *output;
+    const guint8      *cells;
+    gint64             value;
+    guint64            mask;
+    gulong             page;
+    gulong             count;
+    gulong             i;
+    glong              offset;
+    glong              last;
+    gboolean           success;
 
     tape = cattle_interpreter_get_tape (self);
+    priv = tape->priv;
 
-    /* Save the current position so it can be restored later */
-    cattle_tape_push_bookmark (tape);
+    /* Values are printed as unsigned numbers as wide as the cells */
+    mask = G_MAXUINT64 >> (64 - cattle_tape_get_cell_width (tape));
 
-    /* Move to the beginning of the tape, counting how many steps
-     * it takes to get there. This value will be used later to mark
-     * the current position */
-    steps = 0;
-    while (TRUE)
-    {
-        if (cattle_tape_is_at_beginning (tape))
-        {
-            break;
-        }
+    /* Offsets of the first and last valid cells, relative to the
+     * current one. The tape is never moved */
+    offset = -(glong) (priv->current - priv->lower_limit);
+    last = (glong) (priv->upper_limit - priv->current);
 
-        cattle_tape_move_left (tape);
-        steps++;
-    }
+    output = g_string_new ("[");
 
-    buffer[0] = '[';
-    if (G_UNLIKELY (write (2, buffer, 1) < 0))
+    while (offset <= last)
     {
-        g_set_error_literal (error,
-                             CATTLE_ERROR,
-                             CATTLE_ERROR_IO,
-                             strerror (errno));
+        count = (gulong) (last - offset) + 1;
 
-        cattle_tape_pop_bookmark (tape);
-        g_object_unref (tape);
+        /* Look at the cells one page at a time on sparse tapes, so that
+         * pages that have not been allocated read as zeros and are
+         * not allocated as a result */
+        if (priv->pages != NULL)
+        {
+            page = 1UL << priv->page_shift;
+            count = MIN (count,
+                         page - ((priv->current + offset) & (page - 1)));
+        }
 
-        return FALSE;
-    }
+        cells = cattle_tape_peek_range (tape, offset, count);
 
-    while (TRUE)
-    {
-        /* Mark the current position */
-        if (steps == 0)
+        for (i = 0; i < count; i++, offset++)
         {
-            buffer[0] = '<';
-            if (G_UNLIKELY (write (2, buffer, 1) < 0))
+            value = _cattle_cell_get (cells + i * priv->cell_size,
+                                      priv->width);
+
+            /* Mark the current position */
+            if (offset == 0)
             {
-                g_set_error_literal (error,
-                                     CATTLE_ERROR,
-                                     CATTLE_ERROR_IO,
-                                     strerror (errno));
+                g_string_append_c (output, '<');
+            }
 
-                cattle_tape_pop_bookmark (tape);
-                g_object_unref (tape);
+            /* Print the value of the cell if it is a graphical char;
+             * otherwise, print its hexadecimal value */
+            if (value >= 0 && value <= G_MAXINT8 && g_ascii_isgraph ((gchar) value))
+            {
+                g_string_append_c (output, (gchar) value);
+            }
+            else
+            {
+                g_string_append_printf (output,
+                                        "0x%" G_GINT64_MODIFIER "X",
+                                        (guint64) value & mask);
+            }
 
-                return FALSE;
+            if (offset == 0)
+            {
+                g_string_append_c (output, '>');
+            }
+
+            if (offset < last)
+            {
+                g_string_append_c (output, ' ');
             }
         }
+    }
 
-        value = cattle_tape_get_current_value (tape);
+    g_string_append (output, "]\n");
 
-        /* Print the value of the current cell if it is a graphical char;
-         * otherwise, print its hexadecimal value */
-        if (g_ascii_isgraph ((gchar) value))
-        {
-            buffer[0] = value;
-            if (G_UNLIKELY (write (2, buffer, 1) < 0))
-            {
-                g_set_error_literal (error,
-                                     CATTLE_ERROR,
-                                     CATTLE_ERROR_IO,
-                                     strerror (errno));
+    success = TRUE;
+    if (G_UNLIKELY (write (2, output->str, output->len) < 0))
+    {
+        g_set_error_literal (error,
+                             CATTLE_ERROR,
+                             CATTLE_ERROR_IO,
+                             strerror (errno));
 
-                cattle_tape_pop_bookmark (tape);
-                g_object_unref (tape);
+        success = FALSE;
+    }
 
-                return FALSE;
-            }
-        }
-        else {
-            size = snprintf ((gchar *) buffer, 4, "0x%X", value);
+    g_string_free (output, TRUE);
+    g_object_unref (tape);
 
-            if (G_UNLIKELY (write (2, buffer, size) < 0)) {
-                g_set_error_literal (error,
-                                     CATTLE_ERROR,
-                                     CATTLE_ERROR_IO,
-                                     strerror (errno));
+    return success;
+}
 
-                cattle_tape_pop_bookmark (tape);
-                g_object_unref (tape);
+/* Look for cycles in the execution of @loop, which is about to start
+ * a new iteration, using Brent's algorithm. Returns %TRUE if the state
+ * of the cells touched by @loop has already been seen, which means the
+ * loop will never terminate */
+static gboolean
+check_cycle (CattleInterpreter *self,
+             CattleInstruction *loop)
+{
+    CattleInterpreterPrivate *priv;
+    CycleTracker             *tracker;
+    gint64                    window[CATTLE_LOOP_FOOTPRINT_MAX];
+    glong                     lower;
+    glong                     upper;
+    glong                     i;
+    gsize                     size;
 
-                return FALSE;
-            }
-        }
+    priv = self->priv;
 
-        /* Mark the current position */
-        if (steps == 0)
-        {
-            buffer[0] = '>';
-            if (G_UNLIKELY (write (2, buffer, 1) < 0))
-            {
-                g_set_error_literal (error,
-                                     CATTLE_ERROR,
-                                     CATTLE_ERROR_IO,
-                                     strerror (errno));
+    /* Only loops whose footprint is small enough are tracked */
+    if (!_cattle_instruction_get_loop_footprint (loop, &lower, &upper))
+    {
+        return FALSE;
+    }
 
-                cattle_tape_pop_bookmark (tape);
-                g_object_unref (tape);
+    size = (gsize) (upper - lower + 1);
 
-                return FALSE;
-            }
-        }
+    /* Take a snapshot of the cells touched by the loop. Cells the
+     * program has not reached yet are known to contain zero, so they
+     * are not visited: doing so would make the tape grow */
+    memset (window, 0, size * sizeof (gint64));
 
-        /* Exit after printing the last value */
-        if (cattle_tape_is_at_end (tape))
+    cattle_tape_push_bookmark (priv->tape);
+    for (i = 0; i > lower; i--)
+    {
+        if (cattle_tape_is_at_beginning (priv->tape))
         {
             break;
         }
+        cattle_tape_move_left (priv->tape);
+    }
+    while (TRUE)
+    {
+        window[i - lower] = cattle_tape_get_current_wide_value (priv->tape);
 
-        /* Print a space and move forward */
-        buffer[0] = ' ';
-        if (G_UNLIKELY (write (2, buffer, 1) < 0))
+        if (i == upper || cattle_tape_is_at_end (priv->tape))
         {
-            g_set_error_literal (error,
-                                 CATTLE_ERROR,
-                                 CATTLE_ERROR_IO,
-                                 strerror (errno));
-
-            cattle_tape_pop_bookmark (tape);
-            g_object_unref (tape);
-
-            return FALSE;
+            break;
         }
-        cattle_tape_move_right (tape);
-        steps--;
+        cattle_tape_move_right (priv->tape);
+        i++;
     }
+    cattle_tape_pop_bookmark (priv->tape);
 
-    buffer[0] = ']';
-    if (G_UNLIKELY (write (2, buffer, 1) < 0))
+    tracker = g_hash_table_lookup (priv->trackers, loop);
+
+    /* First iteration: just remember the current state */
+    if (tracker == NULL)
     {
-        g_set_error_literal (error,
-                             CATTLE_ERROR,
-                             CATTLE_ERROR_IO,
-                             strerror (errno));
+        tracker = g_new0 (CycleTracker, 1);
+        tracker->power = 1;
+        tracker->length = 0;
+        memcpy (tracker->saved, window, size * sizeof (gint64));
 
-        cattle_tape_pop_bookmark (tape);
-        g_object_unref (tape);
+        g_hash_table_insert (priv->trackers, loop, tracker);
 
         return FALSE;
     }
 
-    buffer[0] = '\n';
-    if (G_UNLIKELY (write (2, buffer, 1) < 0))
+    if (memcmp (tracker->saved, window, size * sizeof (gint64)) == 0)
     {
-        g_set_error_literal (error,
-                             CATTLE_ERROR,
-                             CATTLE_ERROR_IO,
-                             strerror (errno));
-
-        cattle_tape_pop_bookmark (tape);
-        g_object_unref (tape);
-
-        return FALSE;
+        return TRUE;
     }
 
-    /* Restore the previously-saved position */
-    cattle_tape_pop_bookmark (tape);
-
-    g_object_unref (tape);
+    /* Move the saved state forward every time the number of
+     * iterations since the last time it was moved reaches the next
+     * power of two */
+    tracker->length++;
+    if (tracker->length == tracker->power)
+    {
+        memcpy (tracker->saved, window, size * sizeof (gint64));
+        tracker->power *= 2;
+        tracker->length = 0;
+    }
 
-    return TRUE;
+    return FALSE;
 }
 
 static void
@@ -20,6 +20,8 @@
 #include "cattle-enums.h"
 #include "cattle-error.h"
 #include "cattle-program.h"
+#include "cattle-buffer-private.h"
+#include "cattle-instruction-private.h"
 
 /**
  * SECTION:cattle-program
@@ -57,6 +59,12 @@ struct _CattleProgramPrivate
 
     CattleInstruction *instructions;
     CattleBuffer      *input;
+
+    CattleAnalysis    *analysis;    /* Shared by the instructions the
+                                     * extent was computed for, or NULL
+                                     * if the extent is not known */
+    glong              extent_lower;
+    glong              extent_upper;
 };
 
 G_DEFINE_TYPE_WITH_CODE (CattleProgram, cattle_program, G_TYPE_OBJECT,
@@ -70,11 +78,36 @@ enum
     PROP_INPUT
 };
 
+/* Static information about a sequence of instructions. Offsets
+ * are relative to the cell the sequence starts executing on */
+typedef struct
+{
+    gboolean bounded;        /* All pointer movements are known */
+    gboolean pure;           /* No I/O is performed */
+    glong    offset;         /* Offset of the last cell */
+    glong    lower;          /* Lowest offset reached */
+    glong    upper;          /* Highest offset reached */
+    gboolean origin_written; /* First cell might be changed by a
+                              * nested loop or by input */
+    gulong   origin_delta;   /* Net change applied to the first
+                              * cell by increase and decrease
+                              * instructions */
+    gboolean origin_cleared; /* First cell is known to be zero
+                              * at the end */
+    CattleInstruction *end;  /* Instruction ending the loop, if
+                              * the sequence is a loop's body */
+} Summary;
+
 /* Internal functions */
-static gulong load (CattleBuffer       *buffer,
-                    gulong              offset,
-                    CattleInstruction **instructions,
-                    CattleBuffer      **input);
+static gulong load     (CattleBuffer       *buffer,
+                        gulong              offset,
+                        CattleInstruction **instructions,
+                        CattleBuffer      **input);
+static void   analyze  (CattleInstruction  *instructions,
+                        CattleAnalysis     *analysis,
+                        Summary            *summary);
+static void   classify (CattleInstruction  *instruction,
+                        Summary            *body);
 
 /* Symbols used by the code loader */
 #define BANG_SYMBOL    0x21 /*  !  */
@@ -90,6 +123,12 @@ cattle_program_init (CattleProgram *self)
     priv->instructions = cattle_instruction_new ();
     priv->input = cattle_buffer_new (0);
 
+    /* The empty program doesn't move at all */
+    priv->analysis = _cattle_analysis_new ();
+    _cattle_instruction_set_analysis (priv->instructions, priv->analysis);
+    priv->extent_lower = 0;
+    priv->extent_upper = 0;
+
     priv->disposed = FALSE;
 
     self->priv = priv;
@@ -109,6 +148,12 @@ cattle_program_dispose (GObject *object)
     g_object_unref (priv->instructions);
     g_object_unref (priv->input);
 
+    if (priv->analysis != NULL)
+    {
+        _cattle_analysis_unref (priv->analysis);
+        priv->analysis = NULL;
+    }
+
     priv->disposed = TRUE;
 
     G_OBJECT_CLASS (cattle_program_parent_class)->dispose (object);
@@ -130,25 +175,26 @@ load (CattleBuffer       *buffer,
     CattleInstruction *current;
     CattleInstruction *previous;
     CattleInstruction *loop;
+    const gint8       *data;
     gint8              value;
     gint8              temp;
     gulong             quantity;
     gulong             size;
     gulong             i;
-    gulong             c;
 
     first = NULL;
     previous = NULL;
 
     i = offset;
     size = cattle_buffer_get_size (buffer);
+    data = _cattle_buffer_peek_contents (buffer);
 
     while (i < size)
     {
         current = NULL;
 
         /* Read a value from the input buffer */
-        value = cattle_buffer_get_value (buffer, i);
+        value = data[i];
         quantity = 1;
 
         /* Start of program's input, stop parsing */
@@ -194,7 +240,7 @@ load (CattleBuffer       *buffer,
         {
             while (i + 1 < size)
             {
-                temp = cattle_buffer_get_value (buffer, i + 1);
+                temp = data[i + 1];
 
                 if (temp == value)
                 {
@@ -268,19 +314,23 @@ load (CattleBuffer       *buffer,
     /* Collect any input */
     if (input != NULL)
     {
-        if (i < size)
+        if (i < size &&
+            cattle_buffer_get_mode (buffer) == CATTLE_BUFFER_MODE_FIXED)
         {
-            *input = cattle_buffer_new (size - i);
+            /* The input is not copied, but shares the memory of
+             * the code buffer */
+            *input = cattle_buffer_new_slice (buffer, i, size - i);
 
-            c = 0;
-            while (i < size)
-            {
-                value = cattle_buffer_get_value (buffer, i);
-                cattle_buffer_set_value (*input, c, value);
+            i = size;
+        }
+        else if (i < size)
+        {
+            /* The contents of growable buffers can move or change
+             * after loading, so they can't be sliced */
+            *input = cattle_buffer_new (size - i);
+            cattle_buffer_set_contents_at (*input, 0, data + i, size - i);
 
-                c++;
-                i++;
-            }
+            i = size;
         }
         else
         {
@@ -291,6 +341,211 @@ load (CattleBuffer       *buffer,
     return i;
 }
 
+static void
+analyze (CattleInstruction *instructions,
+         CattleAnalysis    *analysis,
+         Summary           *summary)
+{
+    CattleInstruction *current;
+    CattleInstruction *next;
+    CattleInstruction *loop;
+    Summary            body;
+    gulong             quantity;
+
+    summary->bounded = TRUE;
+    summary->pure = TRUE;
+    summary->offset = 0;
+    summary->lower = 0;
+    summary->upper = 0;
+    summary->origin_written = FALSE;
+    summary->origin_delta = 0;
+    summary->origin_cleared = FALSE;
+    summary->end = NULL;
+
+    current = instructions;
+    g_object_ref (current);
+
+    while (current != NULL)
+    {
+        _cattle_instruction_set_analysis (current, analysis);
+
+        quantity = cattle_instruction_get_quantity (current);
+
+        switch (cattle_instruction_get_value (current))
+        {
+            case CATTLE_INSTRUCTION_MOVE_LEFT:
+
+                summary->offset -= quantity;
+                summary->lower = MIN (summary->lower, summary->offset);
+
+                break;
+
+            case CATTLE_INSTRUCTION_MOVE_RIGHT:
+
+                summary->offset += quantity;
+                summary->upper = MAX (summary->upper, summary->offset);
+
+                break;
+
+            case CATTLE_INSTRUCTION_INCREASE:
+
+                if (summary->offset == 0)
+                {
+                    summary->origin_delta += quantity;
+                    summary->origin_cleared = FALSE;
+                }
+
+                break;
+
+            case CATTLE_INSTRUCTION_DECREASE:
+
+                if (summary->offset == 0)
+                {
+                    summary->origin_delta -= quantity;
+                    summary->origin_cleared = FALSE;
+                }
+
+                break;
+
+            case CATTLE_INSTRUCTION_READ:
+
+                summary->pure = FALSE;
+
+                if (summary->offset == 0)
+                {
+                    summary->origin_written = TRUE;
+                    summary->origin_cleared = FALSE;
+                }
+
+                break;
+
+            case CATTLE_INSTRUCTION_PRINT:
+            case CATTLE_INSTRUCTION_DEBUG:
+
+                summary->pure = FALSE;
+
+                break;
+
+            case CATTLE_INSTRUCTION_LOOP_BEGIN:
+
+                loop = cattle_instruction_get_loop (current);
+
+                if (loop == NULL)
+                {
+                    summary->bounded = FALSE;
+                    summary->pure = FALSE;
+
+                    break;
+                }
+
+                analyze (loop, analysis, &body);
+                classify (current, &body);
+                g_object_unref (loop);
+
+                if (!body.pure)
+                {
+                    summary->pure = FALSE;
+                }
+
+                /* Once a loop that doesn't bring the pointer back to
+                 * the cell it started on has been encountered, there's
+                 * no way to know where the pointer is */
+                if (!body.bounded || body.offset != 0)
+                {
+                    summary->bounded = FALSE;
+
+                    break;
+                }
+
+                summary->lower = MIN (summary->lower,
+                                      summary->offset + body.lower);
+                summary->upper = MAX (summary->upper,
+                                      summary->offset + body.upper);
+
+                if (summary->offset == 0)
+                {
+                    /* Loops only terminate when the current cell is
+                     * zero, so the first cell is cleared */
+                    summary->origin_written = TRUE;
+                    summary->origin_cleared = TRUE;
+                }
+                else if (summary->offset + body.lower <= 0 &&
+                         summary->offset + body.upper >= 0)
+                {
+                    summary->origin_written = TRUE;
+                    summary->origin_cleared = FALSE;
+                }
+
+                break;
+
+            case CATTLE_INSTRUCTION_LOOP_END:
+
+                summary->end = current;
+
+                break;
+
+            case CATTLE_INSTRUCTION_NONE:
+            default:
+
+                /* Do nothing */
+
+                break;
+        }
+
+        next = cattle_instruction_get_next (current);
+        g_object_unref (current);
+        current = next;
+    }
+}
+
+static void
+classify (CattleInstruction *instruction,
+          Summary           *body)
+{
+    /* Loops which move the pointer around are never classified */
+    if (!body->bounded || body->offset != 0)
+    {
+        return;
+    }
+
+    if (body->origin_cleared && body->end != NULL)
+    {
+        /* The loop cell is always zero at the end of the body, so
+         * the loop can run at most once */
+        _cattle_instruction_set_loop_kind (instruction,
+                                           CATTLE_LOOP_KIND_CONDITIONAL);
+        _cattle_instruction_set_loop_kind (body->end,
+                                           CATTLE_LOOP_KIND_CONDITIONAL);
+        _cattle_instruction_set_loop_begin (body->end,
+                                            instruction);
+
+        return;
+    }
+
+    /* Non-terminating loops which produce output are left
+     * alone on purpose */
+    if (!body->pure)
+    {
+        return;
+    }
+
+    if (!body->origin_written && body->origin_delta == 0)
+    {
+        /* Every iteration leaves the loop cell unchanged, so the
+         * loop will never terminate once entered */
+        _cattle_instruction_set_loop_kind (instruction,
+                                           CATTLE_LOOP_KIND_INFINITE);
+    }
+    else if (body->upper - body->lower < CATTLE_LOOP_FOOTPRINT_MAX)
+    {
+        /* The whole state of the loop fits in a small window, so
+         * it can be checked for cycles at runtime */
+        _cattle_instruction_set_loop_footprint (instruction,
+                                                body->lower,
+                                                body->upper);
+    }
+}
+
 /**
  * cattle_program_new:
  *
@@ -320,6 +575,21 @@ cattle_program_new (void)
  * in that case, the input must be separated from the code by a bang
  * (!) character.
  *
+ * @buffer is only read, never modified, so it can wrap existing memory
+ * using cattle_buffer_new_from_bytes() or
+ * cattle_buffer_new_with_free_func(). The program's input is a slice
+ * of @buffer, so it's not copied either, unless @buffer is a
+ * %CATTLE_BUFFER_MODE_GROWABLE buffer: in that case the input is
+ * copied, because the contents of @buffer can change afterwards.
+ * %CATTLE_BUFFER_MODE_RING buffers are not supported.
+ *
+ * While loading, loops which are provably unable to terminate once
+ * entered, such as `[]` or `[>+<]`, are detected: running them
+ * results in a %CATTLE_ERROR_INFINITE_LOOP error. Changing any of
+ * the instructions afterwards, for example using
+ * cattle_instruction_set_next(), discards all information collected
+ * this way.
+ *
  * In case of failure, @error is filled with detailed information.
  * The error domain is %CATTLE_ERROR, and the error code is from the
  * #CattleError enumeration.
@@ -334,6 +604,9 @@ cattle_program_load (CattleProgram  *self,
     CattleProgramPrivate *priv;
     CattleInstruction    *instructions;
     CattleBuffer         *input;
+    CattleAnalysis       *analysis;
+    Summary               summary;
+    const gint8          *data;
     gint8                 value;
     glong                 brackets_count;
     gulong                size;
@@ -341,18 +614,20 @@ cattle_program_load (CattleProgram  *self,
 
     g_return_val_if_fail (CATTLE_IS_PROGRAM (self), FALSE);
     g_return_val_if_fail (CATTLE_IS_BUFFER (buffer), FALSE);
+    g_return_val_if_fail (cattle_buffer_get_mode (buffer) != CATTLE_BUFFER_MODE_RING, FALSE);
     g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
     priv = self->priv;
     g_return_val_if_fail (!priv->disposed, FALSE);
 
     size = cattle_buffer_get_size (buffer);
+    data = _cattle_buffer_peek_contents (buffer);
 
     /* Check the number of brackets to ensure the loops are balanced */
     brackets_count = 0;
     for (i = 0; i < size; i++)
     {
-        value = cattle_buffer_get_value (buffer, i);
+        value = data[i];
 
         if (value == CATTLE_INSTRUCTION_LOOP_BEGIN)
         {
@@ -387,10 +662,28 @@ cattle_program_load (CattleProgram  *self,
           &instructions,
           &input);
 
+    /* Collect static information about the program */
+    analysis = _cattle_analysis_new ();
+    analyze (instructions, analysis, &summary);
+
     /* Set instructions and input */
     cattle_program_set_instructions (self, instructions);
     cattle_program_set_input (self, input);
 
+    /* If the pointer movements are known statically, so is the
+     * part of the tape the program can reach, for as long as the
+     * instructions don't change */
+    if (summary.bounded)
+    {
+        priv->analysis = analysis;
+        priv->extent_lower = summary.lower;
+        priv->extent_upper = summary.upper;
+    }
+    else
+    {
+        _cattle_analysis_unref (analysis);
+    }
+
     g_object_unref (instructions);
     g_object_unref (input);
 
@@ -424,6 +717,13 @@ cattle_program_set_instructions (CattleProgram     *self,
 
     priv->instructions = instructions;
     g_object_ref (priv->instructions);
+
+    /* Nothing is known about the new instructions */
+    if (priv->analysis != NULL)
+    {
+        _cattle_analysis_unref (priv->analysis);
+        priv->analysis = NULL;
+    }
 }
 
 /**
@@ -505,6 +805,56 @@ cattle_program_get_input (CattleProgram *self)
     return priv->input;
 }
 
+/**
+ * cattle_program_get_tape_extent:
+ * @program: a #CattleProgram
+ * @lower: (out) (allow-none): return location for the lowest offset
+ * @upper: (out) (allow-none): return location for the highest offset
+ *
+ * Get the part of the tape @program can reach while running, as
+ * offsets relative to the cell the execution starts on.
+ *
+ * The extent is computed by cattle_program_load(), and is only known
+ * if all the loops in @program move the tape back to the cell they
+ * started on; otherwise, if the instructions have been set using
+ * cattle_program_set_instructions(), or if any of them has been
+ * changed since, %FALSE is returned and @lower and @upper are not
+ * modified.
+ *
+ * The extent is conservative: @program is guaranteed not to move
+ * outside of it, but it might not reach all of it.
+ *
+ * Returns: %TRUE if the extent is known, %FALSE otherwise
+ */
+gboolean
+cattle_program_get_tape_extent (CattleProgram *self,
+                                glong         *lower,
+                                glong         *upper)
+{
+    CattleProgramPrivate *priv;
+
+    g_return_val_if_fail (CATTLE_IS_PROGRAM (self), FALSE);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, FALSE);
+
+    if (priv->analysis == NULL || _cattle_analysis_is_stale (priv->analysis))
+    {
+        return FALSE;
+    }
+
+    if (lower != NULL)
+    {
+        *lower = priv->extent_lower;
+    }
+    if (upper != NULL)
+    {
+        *upper = priv->extent_upper;
+    }
+
+    return TRUE;
+}
+
 static void
 cattle_program_set_property (GObject      *object,
                              guint         property_id,
@@ -63,6 +63,9 @@ CattleInstruction* cattle_program_get_instructions (CattleProgram      *program)
 void               cattle_program_set_input        (CattleProgram      *program,
                                                     CattleBuffer       *input);
 CattleBuffer*      cattle_program_get_input        (CattleProgram      *program);
+gboolean           cattle_program_get_tape_extent  (CattleProgram      *program,
+                                                    glong              *lower,
+                                                    glong              *upper);
 
 GType              cattle_program_get_type         (void) G_GNUC_CONST;
 
@@ -0,0 +1,282 @@
+/* Cattle - Brainfuck language toolkit
+ * Copyright (C) 2008-2020  Andrea Bolognani <eof@kiyuko.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Homepage: https://kiyuko.org/software/cattle
+ */
+
+#if !defined (CATTLE_COMPILATION)
+#error "This header is private to Cattle and can't be included directly."
+#endif
+
+#ifndef __CATTLE_TAPE_PRIVATE_H__
+#define __CATTLE_TAPE_PRIVATE_H__
+
+#include "cattle-tape.h"
+
+G_BEGIN_DECLS
+
+typedef struct _CattleTapePage CattleTapePage;
+
+/* Number of bookmarks that can be pushed before the stack has to be
+ * allocated on the heap */
+#define CATTLE_TAPE_INLINE_BOOKMARKS 8
+
+/* Defined here, rather than in cattle-tape.c, so that the fast paths
+ * below can be inlined */
+struct _CattleTapePrivate
+{
+    gboolean           disposed;
+
+    guint8            *cells;       /* Contiguous memory for all cells */
+    gulong             size;        /* Number of allocated cells */
+    CattleCellWidth    width;       /* Number of bits in a cell */
+    gsize              cell_size;   /* Number of bytes in a cell */
+    gboolean           fixed;       /* Whether the tape is not allowed
+                                     * to grow */
+    gboolean           left_growth; /* Whether the tape is allowed to
+                                     * grow on the left */
+    gulong             memory_limit; /* Maximum number of bytes used
+                                      * by cells, or zero */
+    gulong             peak_usage;  /* Maximum number of bytes used by
+                                     * cells so far */
+    gboolean           limit_reached; /* Whether the last attempt at
+                                       * growing failed because of the
+                                       * memory limit */
+
+    CattleTapeBackend  backend;     /* Where cells are allocated */
+    guint8            *map;         /* Reserved address range, for
+                                     * reserved tapes */
+    gsize              map_size;    /* Size of the reserved range */
+    gboolean           huge_pages;  /* Whether the reserved range is
+                                     * backed by huge pages */
+    gint              *shared;      /* Number of tapes sharing cells and
+                                     * map, or NULL if not shared */
+    GHashTable        *pages;       /* Page directory, for sparse
+                                     * tapes */
+    guint              page_shift;  /* Number of bits in the index of a
+                                     * cell inside its page */
+    gulong             cached_page; /* Last page looked up */
+    CattleTapePage    *cached;      /* Last page looked up */
+    guint              sweep_limit; /* Number of pages after which
+                                     * zeroed ones are freed */
+
+    gulong             origin;      /* Index of the cell the tape
+                                     * started on */
+    gulong             current;     /* Index of the current cell */
+    gulong             lower_limit; /* Index of the first valid cell */
+    gulong             upper_limit; /* Index of the last valid cell */
+
+    glong             *bookmarks;   /* Bookmarks stack. Positions are
+                                     * relative to the origin, so that
+                                     * they're not affected by the tape
+                                     * growing */
+    guint              n_bookmarks; /* Number of bookmarks on the
+                                     * stack */
+    guint              max_bookmarks; /* Size of the stack */
+    glong              inline_bookmarks[CATTLE_TAPE_INLINE_BOOKMARKS];
+};
+
+/* Access to the memory backing a single cell. Values are sign-extended
+ * when read and truncated to the width of the cell when written, while
+ * arithmetic wraps around. When @width is known at compile time, each
+ * of these boils down to a single memory access */
+
+static inline gint64
+_cattle_cell_get (gconstpointer   cell,
+                  CattleCellWidth width)
+{
+    switch (width)
+    {
+        case CATTLE_CELL_WIDTH_16:
+            return *(const gint16 *) cell;
+        case CATTLE_CELL_WIDTH_32:
+            return *(const gint32 *) cell;
+        case CATTLE_CELL_WIDTH_64:
+            return *(const gint64 *) cell;
+        case CATTLE_CELL_WIDTH_8:
+        default:
+            return *(const gint8 *) cell;
+    }
+}
+
+static inline void
+_cattle_cell_set (gpointer        cell,
+                  gint64          value,
+                  CattleCellWidth width)
+{
+    switch (width)
+    {
+        case CATTLE_CELL_WIDTH_16:
+            *(guint16 *) cell = (guint16) value;
+            break;
+        case CATTLE_CELL_WIDTH_32:
+            *(guint32 *) cell = (guint32) value;
+            break;
+        case CATTLE_CELL_WIDTH_64:
+            *(guint64 *) cell = (guint64) value;
+            break;
+        case CATTLE_CELL_WIDTH_8:
+        default:
+            *(guint8 *) cell = (guint8) value;
+            break;
+    }
+}
+
+static inline void
+_cattle_cell_add (gpointer        cell,
+                  guint64         amount,
+                  CattleCellWidth width)
+{
+    switch (width)
+    {
+        case CATTLE_CELL_WIDTH_16:
+            *(guint16 *) cell += (guint16) amount;
+            break;
+        case CATTLE_CELL_WIDTH_32:
+            *(guint32 *) cell += (guint32) amount;
+            break;
+        case CATTLE_CELL_WIDTH_64:
+            *(guint64 *) cell += amount;
+            break;
+        case CATTLE_CELL_WIDTH_8:
+        default:
+            *(guint8 *) cell += (guint8) amount;
+            break;
+    }
+}
+
+gpointer      _cattle_tape_get_current_cell_slow  (CattleTape *tape);
+gconstpointer _cattle_tape_peek_current_cell_slow (CattleTape *tape);
+
+/* Fast paths for the operations the interpreter performs most often.
+ * Unlike the public API they perform no checks at all, and they only
+ * handle the common case themselves, falling back to the regular
+ * implementation for everything else */
+
+/* Memory backing the current cell. It's only valid until the tape is
+ * moved, and must be accessed according to the tape's cell width */
+static inline gpointer
+_cattle_tape_get_current_cell (CattleTape *tape)
+{
+    CattleTapePrivate *priv;
+
+    priv = tape->priv;
+
+    /* Cells of sparse tapes and shared cells might have to be
+     * allocated or copied first */
+    if (G_LIKELY (priv->pages == NULL && priv->shared == NULL))
+    {
+        return priv->cells + priv->current * priv->cell_size;
+    }
+
+    return _cattle_tape_get_current_cell_slow (tape);
+}
+
+/* Same as _cattle_tape_get_current_cell(), but the memory must not be
+ * written to. Reading never causes memory to be allocated or copied */
+static inline gconstpointer
+_cattle_tape_peek_current_cell (CattleTape *tape)
+{
+    CattleTapePrivate *priv;
+
+    priv = tape->priv;
+
+    if (G_LIKELY (priv->pages == NULL))
+    {
+        return priv->cells + priv->current * priv->cell_size;
+    }
+
+    return _cattle_tape_peek_current_cell_slow (tape);
+}
+
+/* Same as cattle_tape_move_left_by() */
+static inline gboolean
+_cattle_tape_move_left_by (CattleTape *tape,
+                           gulong      steps)
+{
+    CattleTapePrivate *priv;
+
+    priv = tape->priv;
+
+    /* Tapes that can't grow on the left start on their first cell, so
+     * there's no lower limit to keep track of */
+    if (G_LIKELY (!priv->left_growth && priv->pages == NULL))
+    {
+        if (G_LIKELY (steps <= priv->current))
+        {
+            priv->current -= steps;
+
+            return TRUE;
+        }
+
+        return cattle_tape_move_left_by (tape, steps);
+    }
+
+    /* No need to grow, nor to check the memory limit */
+    if (G_LIKELY (priv->left_growth &&
+                  steps <= priv->current &&
+                  (priv->pages == NULL || priv->memory_limit == 0)))
+    {
+        priv->current -= steps;
+
+        if (priv->current < priv->lower_limit)
+        {
+            priv->lower_limit = priv->current;
+        }
+
+        return TRUE;
+    }
+
+    return cattle_tape_move_left_by (tape, steps);
+}
+
+/* Same as cattle_tape_move_right_by() */
+static inline gboolean
+_cattle_tape_move_right_by (CattleTape *tape,
+                            gulong      steps)
+{
+    CattleTapePrivate *priv;
+
+    priv = tape->priv;
+
+    /* No need to grow, nor to check the memory limit */
+    if (G_LIKELY (steps < priv->size - priv->current &&
+                  (priv->pages == NULL || priv->memory_limit == 0)))
+    {
+        priv->current += steps;
+
+        if (priv->current > priv->upper_limit)
+        {
+            priv->upper_limit = priv->current;
+        }
+
+        return TRUE;
+    }
+
+    return cattle_tape_move_right_by (tape, steps);
+}
+
+/* Whether the last attempt at growing the tape, for example when
+ * moving it, failed because of its memory limit */
+static inline gboolean
+_cattle_tape_get_memory_limit_reached (CattleTape *tape)
+{
+    return tape->priv->limit_reached;
+}
+
+G_END_DECLS
+
+#endif /* __CATTLE_TAPE_PRIVATE_H__ */
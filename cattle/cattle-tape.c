@@ -17,8 +17,29 @@
  * Homepage: https://kiyuko.org/software/cattle
  */
 
+#include "config.h"
+#include "cattle-enums.h"
+#include "cattle-error.h"
 #include "cattle-tape.h"
-#include "cattle-buffer.h"
+#include "cattle-tape-private.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#if defined (HAVE_SYS_MMAN_H) && defined (HAVE_MMAP) && defined (HAVE_MPROTECT)
+#define MAPPED_IS_SUPPORTED 1
+#include <sys/mman.h>
+#if !defined (MAP_ANONYMOUS) && defined (MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#if defined (HAVE_MADVISE) && defined (MADV_HUGEPAGE)
+#define HUGE_PAGES_ARE_SUPPORTED 1
+#endif
+#endif
 
 /**
  * SECTION:cattle-tape
@@ -38,6 +59,85 @@
  * being the amount of available memory. It is possible to check if the
  * current cell is at the beginning or at the end of the tape using
  * cattle_tape_is_at_beginning() and cattle_tape_is_at_end().
+ *
+ * Alternatively, a tape with a fixed number of cells can be created
+ * using cattle_tape_new_with_size(): all memory for such a tape is
+ * allocated up front, and attempts to move past either one of its
+ * edges fail instead of making the tape grow.
+ *
+ * Growth on the left side can also be disabled on its own, using
+ * cattle_tape_set_left_growth_is_enabled(), for programs that are not
+ * supposed to ever move to the left of the cell they started on.
+ *
+ * Each cell is 8 bits wide by default, but tapes with 16, 32 or 64 bits
+ * wide cells can be created using cattle_tape_new_with_cell_width();
+ * cattle_tape_set_current_wide_value() and
+ * cattle_tape_get_current_wide_value() give access to the full value
+ * stored in such cells. Arithmetic on cells always wraps around.
+ *
+ * The memory used by a growable tape can come from one of three
+ * backends, chosen when the tape is created using
+ * cattle_tape_new_with_backend(). The default backend allocates cells
+ * on the heap, and has to copy them over to a larger area every time
+ * the tape grows on the left. The reserved backend instead reserves a
+ * large range of address space up front and makes more of it usable
+ * as the tape grows, so that cells never have to be moved around; the
+ * only downside is that, once the reserved range has been used up,
+ * attempts to move further will fail. Moving the tape involves the
+ * same checks regardless of the backend.
+ *
+ * Finally, the sparse backend splits the tape into pages which are
+ * only allocated once they're written to, and periodically returns
+ * pages that contain nothing but zeros to the system: this makes it
+ * possible for programs to wander very far away from the origin
+ * without memory usage growing to match.
+ *
+ * cattle_tape_snapshot() creates a copy of a tape that shares memory
+ * with the original one, deferring the copy until either one of them
+ * is written to. For sparse tapes, only the pages being written to are
+ * copied, which makes taking many snapshots a cheap way to run several
+ * programs, or the same program with different inputs, starting from
+ * a common state. For the other backends, the first write copies all
+ * cells at once, so each snapshot ends up costing as much as a full
+ * copy of the tape.
+ *
+ * The amount of memory a tape can use is unlimited by default, but a
+ * limit can be set using cattle_tape_set_memory_limit(): once it has
+ * been reached, moving the tape fails just like it does for tapes
+ * with a fixed size, and a %CATTLE_ERROR_TAPE_MEMORY_LIMIT error is
+ * reported by the interpreter.
+ *
+ * The state of a tape can be saved to a file using cattle_tape_save()
+ * and restored later using cattle_tape_load(), for example to resume
+ * a long computation after it has been interrupted. Tapes using the
+ * %CATTLE_TAPE_BACKEND_RESERVED backend map the file into memory
+ * directly instead of reading it, so restoring them is almost free
+ * regardless of their size.
+ */
+
+/**
+ * CattleTapeBackend:
+ * @CATTLE_TAPE_BACKEND_HEAP: Cells are allocated on the heap. This is
+ * the default backend
+ * @CATTLE_TAPE_BACKEND_RESERVED: Cells live in a large range of address
+ * space reserved when the tape is created, and memory is committed
+ * as the tape grows, so cells are never copied. Not available on all
+ * platforms
+ * @CATTLE_TAPE_BACKEND_SPARSE: Cells are grouped in pages, which are
+ * allocated when first written to and freed once they only contain
+ * zeros
+ *
+ * Possible sources for the memory used by a #CattleTape.
+ */
+
+/**
+ * CattleCellWidth:
+ * @CATTLE_CELL_WIDTH_8: Cells are 8 bits wide. This is the default
+ * @CATTLE_CELL_WIDTH_16: Cells are 16 bits wide
+ * @CATTLE_CELL_WIDTH_32: Cells are 32 bits wide
+ * @CATTLE_CELL_WIDTH_64: Cells are 64 bits wide
+ *
+ * Possible widths for the cells of a #CattleTape.
  */
 
 /**
@@ -47,41 +147,73 @@
  * be accessed directly.
  */
 
-struct _CattleTapePrivate
-{
-    gboolean  disposed;
-
-    GList    *current;     /* Current chunk */
-    GList    *head;        /* First chunk */
-
-    gulong    offset;      /* Offset of the current cell */
-    gulong    lower_limit; /* Offset of the first valid byte
-                            * inside the first chunk */
-    gulong    upper_limit; /* Offset of the last valid byte inside
-                            * the last chunk */
-
-    GSList   *bookmarks;   /* Bookmarks stack */
-};
-
 G_DEFINE_TYPE_WITH_CODE (CattleTape, cattle_tape, G_TYPE_OBJECT,
                          G_ADD_PRIVATE (CattleTape))
 
 /* Properties */
 enum {
     PROP_0,
+    PROP_SIZE,
+    PROP_BACKEND,
+    PROP_CELL_WIDTH,
+    PROP_LEFT_GROWTH_IS_ENABLED,
+    PROP_MEMORY_LIMIT,
+    PROP_HUGE_PAGES_ARE_ENABLED,
     PROP_CURRENT_VALUE
 };
 
-typedef struct _CattleTapeBookmark CattleTapeBookmark;
+/* Size of a page of a sparse tape, in bytes */
+#define SPARSE_PAGE_SIZE 4096
 
-struct _CattleTapeBookmark
+/* Page of a sparse tape. Pages can be shared between a tape and its
+ * snapshots, in which case they're copied before being written to */
+struct _CattleTapePage
 {
-    GList   *chunk;
-    gulong   offset;
+    gint    ref_count;
+    guint64 cells[SPARSE_PAGE_SIZE / sizeof (guint64)];
 };
 
-/* Size of the tape chunk */
-#define CHUNK_SIZE 256
+/* Number of cells allocated for a new tape */
+#define INITIAL_SIZE 256
+
+/* Address of the cell at @index. Doesn't work for sparse tapes */
+#define CELL(priv, index) ((priv)->cells + (index) * (priv)->cell_size)
+
+/* Tape files contain the values of all valid cells, followed by the
+ * positions of all bookmarks and by a trailer describing the contents.
+ * Everything is stored in host byte order. Having the cells at the
+ * very beginning of the file means they can be mapped into memory
+ * directly, while the trailer can always be found at the end */
+typedef struct
+{
+    gchar   magic[8];    /* TAPE_FILE_MAGIC */
+    guint32 version;     /* TAPE_FILE_VERSION */
+    guint32 width;       /* Number of bits in a cell */
+    guint64 length;      /* Number of cells */
+    gint64  current;     /* Position of the current cell */
+    gint64  origin;      /* Position of the origin */
+    guint64 n_bookmarks; /* Number of bookmarks */
+} TapeFileTrailer;
+
+#define TAPE_FILE_MAGIC   "CATTAPE"
+#define TAPE_FILE_VERSION 1
+
+/* Smallest number of pages a sparse tape can have before freeing
+ * those that only contain zeros */
+#define SPARSE_SWEEP_LIMIT 16
+
+/* Amount of address space set aside for tapes using the reserved
+ * backend. The tape starts in the middle, so each side gets half
+ * of it */
+#if GLIB_SIZEOF_VOID_P > 4
+#define RESERVED_SIZE (G_GUINT64_CONSTANT (1) << 34)
+#else
+#define RESERVED_SIZE (1 << 28)
+#endif
+
+static gboolean grow (CattleTapePrivate *priv,
+                      gulong             before,
+                      gulong             after);
 
 static void
 cattle_tape_init (CattleTape *self)
@@ -90,438 +222,2740 @@ cattle_tape_init (CattleTape *self)
 
     priv = cattle_tape_get_instance_private (self);
 
-    priv->head = NULL;
-    priv->current = NULL;
-
-    /* Create the first chunk */
-    priv->head = g_list_append (priv->head, (gpointer) cattle_buffer_new (CHUNK_SIZE));
-    priv->current = priv->head;
-
-    /* Set the initial limits */
-    priv->offset = 0;
+    /* Cells are allocated once the size is known */
+    priv->cells = NULL;
+    priv->size = 0;
+    priv->width = CATTLE_CELL_WIDTH_8;
+    priv->cell_size = 1;
+    priv->fixed = FALSE;
+    priv->left_growth = TRUE;
+    priv->memory_limit = 0;
+    priv->peak_usage = 0;
+    priv->limit_reached = FALSE;
+
+    priv->backend = CATTLE_TAPE_BACKEND_HEAP;
+    priv->map = NULL;
+    priv->map_size = 0;
+    priv->huge_pages = FALSE;
+    priv->shared = NULL;
+    priv->pages = NULL;
+    priv->page_shift = 0;
+    priv->cached_page = 0;
+    priv->cached = NULL;
+    priv->sweep_limit = SPARSE_SWEEP_LIMIT;
+
+    priv->origin = 0;
+    priv->current = 0;
     priv->lower_limit = 0;
     priv->upper_limit = 0;
 
     /* Initialize the bookmarks stack */
-    priv->bookmarks = NULL;
+    priv->bookmarks = priv->inline_bookmarks;
+    priv->n_bookmarks = 0;
+    priv->max_bookmarks = CATTLE_TAPE_INLINE_BOOKMARKS;
 
     priv->disposed = FALSE;
 
-    self->priv = priv;
+    self->priv = priv;
+}
+
+#ifdef MAPPED_IS_SUPPORTED
+static gsize
+get_page_size (void)
+{
+    return (gsize) sysconf (_SC_PAGESIZE);
+}
+
+/* Round the number of cells to be committed before (if @before is
+ * %TRUE) or after the committed range up, so that the new edge of the
+ * range is aligned to @page bytes, without going over the @available
+ * cells */
+static gulong
+map_round (CattleTapePrivate *priv,
+           gulong             cells,
+           gulong             available,
+           gsize              page,
+           gboolean           before)
+{
+    guintptr edge;
+
+    cells = MIN (cells, available);
+    if (cells == 0)
+    {
+        return 0;
+    }
+
+    if (before)
+    {
+        edge = (guintptr) priv->cells - cells * priv->cell_size;
+        edge &= ~((guintptr) page - 1);
+        cells = ((guintptr) priv->cells - edge) / priv->cell_size;
+    }
+    else
+    {
+        edge = (guintptr) CELL (priv, priv->size) + cells * priv->cell_size;
+        edge = (edge + page - 1) & ~((guintptr) page - 1);
+        cells = (edge - (guintptr) CELL (priv, priv->size)) / priv->cell_size;
+    }
+
+    return MIN (cells, available);
+}
+#endif
+
+/* Size of a huge page on most architectures. Committing memory for
+ * reserved tapes in aligned blocks of this size allows the kernel to
+ * back them with huge pages */
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+/* Reserve address space for a tape using the reserved backend, and
+ * commit a couple of pages in the middle of it. Pages that have not been committed yet
+ * can't be accessed at all, but moves never rely on that: they're
+ * checked against the committed range, which grows on demand */
+static gboolean
+map_reserve (CattleTapePrivate *priv)
+{
+#ifdef MAPPED_IS_SUPPORTED
+    gpointer map;
+    gsize    page;
+
+    map = mmap (NULL, RESERVED_SIZE, PROT_NONE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED)
+    {
+        return FALSE;
+    }
+
+    page = get_page_size ();
+    priv->map = map;
+    priv->map_size = RESERVED_SIZE;
+    priv->cells = priv->map + (priv->map_size / 2) - page;
+
+    if (mprotect (priv->cells, 2 * page, PROT_READ | PROT_WRITE) != 0)
+    {
+        munmap (priv->map, priv->map_size);
+        priv->map = NULL;
+        priv->map_size = 0;
+        priv->cells = NULL;
+
+        return FALSE;
+    }
+
+    priv->size = (2 * page) / priv->cell_size;
+    priv->origin = page / priv->cell_size;
+
+    return TRUE;
+#else
+    (void) priv;
+
+    return FALSE;
+#endif
+}
+
+/* Commit more of the address space reserved for a tape. At least
+ * @needed_left cells before and @needed_right cells after the
+ * committed ones have to become usable; @left and @right contain the
+ * desired amounts, and are updated to reflect what was committed.
+ * No more than @room cells can be committed in total. Freshly
+ * committed memory always reads as zero */
+static gboolean
+map_commit (CattleTapePrivate *priv,
+            gulong             needed_left,
+            gulong             needed_right,
+            gulong             room,
+            gulong            *left,
+            gulong            *right)
+{
+#ifdef MAPPED_IS_SUPPORTED
+    gsize page;
+    gsize available_left;
+    gsize available_right;
+    gsize bytes;
+
+    available_left = (priv->cells - priv->map) / priv->cell_size;
+    available_right = (priv->map + priv->map_size - CELL (priv, priv->size)) / priv->cell_size;
+    if (needed_left > available_left || needed_right > available_right)
+    {
+        return FALSE;
+    }
+
+    /* Only whole pages can be committed */
+    page = priv->huge_pages ? HUGE_PAGE_SIZE : get_page_size ();
+    *left = map_round (priv, *left, available_left, page, TRUE);
+    *right = map_round (priv, *right, available_right, page, FALSE);
+
+    /* Rounding might take the tape over its memory limit: commit as
+     * little as possible in that case */
+    if (*left > room || *right > room - *left)
+    {
+        page = get_page_size ();
+        *left = map_round (priv, needed_left, available_left, page, TRUE);
+        *right = map_round (priv, needed_right, available_right, page, FALSE);
+
+        if (*left > room || *right > room - *left)
+        {
+            priv->limit_reached = TRUE;
+
+            return FALSE;
+        }
+    }
+
+    bytes = *left * priv->cell_size;
+    if (bytes > 0 &&
+        mprotect (priv->cells - bytes, bytes, PROT_READ | PROT_WRITE) != 0)
+    {
+        return FALSE;
+    }
+    bytes = *right * priv->cell_size;
+    if (bytes > 0 &&
+        mprotect (CELL (priv, priv->size), bytes, PROT_READ | PROT_WRITE) != 0)
+    {
+        /* Cells committed on the left are simply left unused */
+        return FALSE;
+    }
+
+    return TRUE;
+#else
+    (void) priv;
+    (void) needed_left;
+    (void) needed_right;
+    (void) room;
+    (void) left;
+    (void) right;
+
+    return FALSE;
+#endif
+}
+
+/* Number of bytes used by the cells of a tape */
+static gulong
+memory_usage (CattleTapePrivate *priv)
+{
+    if (priv->pages != NULL)
+    {
+        return g_hash_table_size (priv->pages) * SPARSE_PAGE_SIZE;
+    }
+
+    return priv->size * priv->cell_size;
+}
+
+/* Keep track of the maximum amount of memory used so far */
+static void
+update_peak_usage (CattleTapePrivate *priv)
+{
+    priv->peak_usage = MAX (priv->peak_usage, memory_usage (priv));
+}
+
+static CattleTapePage*
+sparse_page_new (void)
+{
+    CattleTapePage *page;
+
+    page = g_new0 (CattleTapePage, 1);
+    page->ref_count = 1;
+
+    return page;
+}
+
+static CattleTapePage*
+sparse_page_ref (CattleTapePage *page)
+{
+    g_atomic_int_inc (&page->ref_count);
+
+    return page;
+}
+
+static void
+sparse_page_unref (CattleTapePage *page)
+{
+    if (g_atomic_int_dec_and_test (&page->ref_count))
+    {
+        g_free (page);
+    }
+}
+
+/* Check whether a page of a sparse tape only contains zeros */
+static gboolean
+sparse_page_is_zero (const CattleTapePage *page)
+{
+    gsize i;
+
+    for (i = 0; i < G_N_ELEMENTS (page->cells); i++)
+    {
+        if (page->cells[i] != 0)
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/* Free all pages of a sparse tape that only contain zeros. Sweeping
+ * only happens once the number of pages has doubled since the last
+ * time, so that its cost is spread over page allocations */
+static void
+sparse_sweep (CattleTapePrivate *priv)
+{
+    GHashTableIter iter;
+    gpointer       page;
+
+    g_hash_table_iter_init (&iter, priv->pages);
+    while (g_hash_table_iter_next (&iter, NULL, &page))
+    {
+        if (sparse_page_is_zero (page))
+        {
+            g_hash_table_iter_remove (&iter);
+        }
+    }
+
+    priv->cached = NULL;
+    priv->sweep_limit = MAX (2 * g_hash_table_size (priv->pages),
+                             SPARSE_SWEEP_LIMIT);
+}
+
+/* Find the cell at @index in a sparse tape. If @write is %TRUE, the
+ * page containing it is allocated if needed, or copied if it's shared
+ * with other tapes; otherwise, %NULL is returned if the page has not
+ * been allocated yet */
+static guint8*
+sparse_lookup (CattleTapePrivate *priv,
+               gulong             index,
+               gboolean           write)
+{
+    CattleTapePage *page;
+    CattleTapePage *copy;
+    gulong          number;
+    gulong          offset;
+
+    number = index >> priv->page_shift;
+    offset = (index & ((1UL << priv->page_shift) - 1)) * priv->cell_size;
+
+    /* Programs tend to spend a long time on the same page, but
+     * it might have become shared since it was cached */
+    page = priv->cached;
+    if (G_LIKELY (page != NULL && number == priv->cached_page) &&
+        (!write || g_atomic_int_get (&page->ref_count) == 1))
+    {
+        return (guint8 *) page->cells + offset;
+    }
+
+    page = g_hash_table_lookup (priv->pages, GSIZE_TO_POINTER (number));
+
+    if (page == NULL)
+    {
+        if (!write)
+        {
+            return NULL;
+        }
+
+        if (g_hash_table_size (priv->pages) >= priv->sweep_limit)
+        {
+            sparse_sweep (priv);
+        }
+
+        page = sparse_page_new ();
+        g_hash_table_insert (priv->pages, GSIZE_TO_POINTER (number), page);
+        update_peak_usage (priv);
+    }
+    else if (write && g_atomic_int_get (&page->ref_count) > 1)
+    {
+        /* Replacing the page drops our reference to the shared one */
+        copy = sparse_page_new ();
+        memcpy (copy->cells, page->cells, sizeof (page->cells));
+        g_hash_table_insert (priv->pages, GSIZE_TO_POINTER (number), copy);
+        page = copy;
+    }
+
+    priv->cached_page = number;
+    priv->cached = page;
+
+    return (guint8 *) page->cells + offset;
+}
+
+/* Make sure pages can be allocated for all @count cells starting at
+ * @first without going over the memory limit. Copying shared pages
+ * doesn't change the number of pages, so they're not taken into
+ * account */
+static gboolean
+sparse_reserve (CattleTapePrivate *priv,
+                gulong             first,
+                gulong             count)
+{
+    gulong number;
+    gulong last;
+    gulong missing;
+    gulong usage;
+    guint  attempt;
+
+    if (G_LIKELY (priv->memory_limit == 0))
+    {
+        return TRUE;
+    }
+
+    priv->limit_reached = FALSE;
+
+    last = (first + (count - 1)) >> priv->page_shift;
+
+    for (attempt = 0; attempt < 2; attempt++)
+    {
+        missing = 0;
+        for (number = first >> priv->page_shift; ; number++)
+        {
+            if ((priv->cached == NULL || number != priv->cached_page) &&
+                g_hash_table_lookup (priv->pages, GSIZE_TO_POINTER (number)) == NULL)
+            {
+                missing++;
+            }
+
+            if (number == last)
+            {
+                break;
+            }
+        }
+
+        usage = memory_usage (priv);
+        if (usage <= priv->memory_limit &&
+            missing <= (priv->memory_limit - usage) / SPARSE_PAGE_SIZE)
+        {
+            return TRUE;
+        }
+
+        /* Try again after freeing unused pages */
+        sparse_sweep (priv);
+    }
+
+    priv->limit_reached = TRUE;
+
+    return FALSE;
+}
+
+/* Release cells shared by a tape and its snapshots. The memory is
+ * only actually freed once no tape is using it anymore */
+static void
+release_cells (guint8 *cells,
+               guint8 *map,
+               gsize   map_size,
+               gint   *shared)
+{
+    if (shared != NULL)
+    {
+        if (!g_atomic_int_dec_and_test (shared))
+        {
+            return;
+        }
+        g_free (shared);
+    }
+
+#ifdef MAPPED_IS_SUPPORTED
+    if (map != NULL)
+    {
+        munmap (map, map_size);
+
+        return;
+    }
+#else
+    (void) map;
+    (void) map_size;
+#endif
+
+    g_free (cells);
+}
+
+/* Replace the cells of a tape with the first @length cells stored in
+ * the file @fd refers to, mapped into memory in the middle of a newly
+ * reserved address range. The first cell ends up at index zero */
+static gboolean
+map_load (CattleTapePrivate *priv,
+          gint               fd,
+          gulong             length)
+{
+#ifdef MAPPED_IS_SUPPORTED
+    guint8 *map;
+    guint8 *cells;
+    gsize   page;
+    gsize   bytes;
+    gsize   mapped;
+
+    page = get_page_size ();
+    bytes = length * priv->cell_size;
+    mapped = ((bytes + page - 1) / page) * page;
+
+    if (mapped > RESERVED_SIZE / 2 ||
+        (priv->memory_limit > 0 && mapped > priv->memory_limit))
+    {
+        return FALSE;
+    }
+
+    map = mmap (NULL, RESERVED_SIZE, PROT_NONE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED)
+    {
+        return FALSE;
+    }
+
+    /* Private mappings are copy-on-write, so changes to the cells
+     * are never written back to the file */
+    cells = map + RESERVED_SIZE / 2;
+    if (mmap (cells, mapped, PROT_READ | PROT_WRITE,
+              MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+    {
+        munmap (map, RESERVED_SIZE);
+
+        return FALSE;
+    }
+
+    /* The last page also contains the rest of the file, but cells
+     * past the last valid one must read as zero */
+    memset (cells + bytes, 0, mapped - bytes);
+
+#ifdef HUGE_PAGES_ARE_SUPPORTED
+    /* Keep using huge pages if the tape was, both for the cells copied
+     * from the file and for the ones committed later. Not being able
+     * to is not fatal */
+    if (priv->huge_pages &&
+        madvise (map, RESERVED_SIZE, MADV_HUGEPAGE) != 0)
+    {
+        priv->huge_pages = FALSE;
+    }
+#else
+    priv->huge_pages = FALSE;
+#endif
+
+    release_cells (priv->cells, priv->map, priv->map_size, priv->shared);
+
+    priv->map = map;
+    priv->map_size = RESERVED_SIZE;
+    priv->shared = NULL;
+    priv->cells = cells;
+    priv->size = mapped / priv->cell_size;
+
+    return TRUE;
+#else
+    (void) priv;
+    (void) fd;
+    (void) length;
+
+    return FALSE;
+#endif
+}
+
+/* Make sure a tape that is not sparse doesn't share its cells with
+ * any other tape before they're modified, copying them if needed.
+ * Only cells in the used range are copied, all other cells being
+ * known to contain zero. If @copy is %FALSE, cells are not copied at
+ * all, and newly allocated ones only contain zeros */
+static void
+unshare (CattleTapePrivate *priv,
+         gboolean           copy)
+{
+    guint8 *cells;
+    guint8 *map;
+    gsize   map_size;
+    gsize   offset;
+    gsize   used;
+
+    if (g_atomic_int_get (priv->shared) == 1)
+    {
+        g_free (priv->shared);
+        priv->shared = NULL;
+
+        return;
+    }
+
+    cells = priv->cells;
+    map = priv->map;
+    map_size = priv->map_size;
+
+    offset = priv->lower_limit * priv->cell_size;
+    used = (priv->upper_limit - priv->lower_limit + 1) * priv->cell_size;
+
+#ifdef MAPPED_IS_SUPPORTED
+    if (map != NULL)
+    {
+        gpointer range;
+
+        /* Reserve a new range and commit the same pages */
+        range = mmap (NULL, map_size, PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (range != MAP_FAILED &&
+            mprotect ((guint8 *) range + (cells - map),
+                      priv->size * priv->cell_size,
+                      PROT_READ | PROT_WRITE) != 0)
+        {
+            munmap (range, map_size);
+            range = MAP_FAILED;
+        }
+
+#ifdef HUGE_PAGES_ARE_SUPPORTED
+        if (range != MAP_FAILED && priv->huge_pages)
+        {
+            /* Not being able to use huge pages is not fatal */
+            madvise (range, map_size, MADV_HUGEPAGE);
+        }
+#endif
+
+        if (range != MAP_FAILED)
+        {
+            priv->map = range;
+            priv->cells = priv->map + (cells - map);
+        }
+        else
+        {
+            /* Fall back to the heap: indexes don't change */
+            priv->map = NULL;
+            priv->map_size = 0;
+            priv->huge_pages = FALSE;
+            priv->backend = CATTLE_TAPE_BACKEND_HEAP;
+            priv->cells = g_malloc0_n (priv->size, priv->cell_size);
+        }
+    }
+    else
+#endif
+    {
+        priv->cells = g_malloc0_n (priv->size, priv->cell_size);
+    }
+
+    if (copy)
+    {
+        memcpy (priv->cells + offset, cells + offset, used);
+    }
+
+    release_cells (cells, map, map_size, priv->shared);
+    priv->shared = NULL;
+}
+
+/* Move the valid cells of a tape that is not sparse to the beginning
+ * of its memory, so that the first one has index zero. Tapes that
+ * can't grow on the left are always kept this way: the index of the
+ * current cell is then also the number of cells on its left, and all
+ * the memory allocated for the tape can be used by moving right */
+static void
+rebase (CattleTapePrivate *priv)
+{
+    gulong shift;
+    gulong count;
+
+    shift = priv->lower_limit;
+    if (priv->pages != NULL || priv->cells == NULL || shift == 0)
+    {
+        return;
+    }
+
+    if (priv->shared != NULL)
+    {
+        unshare (priv, TRUE);
+    }
+
+    count = priv->upper_limit - priv->lower_limit + 1;
+    memmove (priv->cells, CELL (priv, shift), count * priv->cell_size);
+
+    /* Cells past the last valid one must read as zero */
+    memset (CELL (priv, count), 0, shift * priv->cell_size);
+
+    /* Bookmarks are relative to the origin, so they're not affected */
+    priv->origin -= shift;
+    priv->current -= shift;
+    priv->lower_limit = 0;
+    priv->upper_limit -= shift;
+}
+
+/* Memory backing the current cell. If @write is %TRUE, the memory is
+ * guaranteed not to be shared with any other tape; otherwise, for
+ * sparse tapes, %NULL is returned if the cell has never been written
+ * to */
+static inline guint8*
+current_cell (CattleTapePrivate *priv,
+              gboolean           write)
+{
+    if (G_UNLIKELY (priv->pages != NULL))
+    {
+        return sparse_lookup (priv, priv->current, write);
+    }
+
+    if (G_UNLIKELY (write && priv->shared != NULL))
+    {
+        unshare (priv, TRUE);
+    }
+
+    return CELL (priv, priv->current);
+}
+
+static void
+cattle_tape_constructed (GObject *object)
+{
+    CattleTape        *self;
+    CattleTapePrivate *priv;
+
+    self = CATTLE_TAPE (object);
+    priv = self->priv;
+
+    G_OBJECT_CLASS (cattle_tape_parent_class)->constructed (object);
+
+    priv->cell_size = priv->width / 8;
+
+    if (priv->fixed)
+    {
+        /* Fixed-size tapes start on their first cell, and never
+         * grow: all the memory is allocated right away */
+        priv->cells = g_malloc0_n (priv->size, priv->cell_size);
+        priv->backend = CATTLE_TAPE_BACKEND_HEAP;
+    }
+    else if (priv->backend == CATTLE_TAPE_BACKEND_SPARSE)
+    {
+        /* Pages are allocated as needed anywhere in the range of
+         * possible indexes, so the tape never has to grow */
+        priv->pages = g_hash_table_new_full (g_direct_hash,
+                                             g_direct_equal,
+                                             NULL,
+                                             (GDestroyNotify) sparse_page_unref);
+        priv->page_shift = g_bit_storage (SPARSE_PAGE_SIZE / priv->cell_size) - 1;
+        priv->size = G_MAXULONG;
+        priv->origin = G_MAXULONG / 2;
+    }
+    else if (priv->backend == CATTLE_TAPE_BACKEND_RESERVED &&
+             map_reserve (priv))
+    {
+        /* The origin has already been placed in the middle of the
+         * committed pages */
+    }
+    else
+    {
+        /* Fall back to the heap if address space can't be reserved */
+        priv->backend = CATTLE_TAPE_BACKEND_HEAP;
+
+        /* Start in the middle of the allocated cells, so that the
+         * tape can grow in both directions before reallocating. If
+         * it can't grow on the left, start on the first cell instead */
+        priv->cells = g_malloc0_n (INITIAL_SIZE, priv->cell_size);
+        priv->size = INITIAL_SIZE;
+        priv->origin = priv->left_growth ? INITIAL_SIZE / 2 : 0;
+    }
+
+    /* Set the initial limits */
+    priv->current = priv->origin;
+    priv->lower_limit = priv->origin;
+    priv->upper_limit = priv->origin;
+
+    if (!priv->left_growth)
+    {
+        rebase (priv);
+    }
+
+    update_peak_usage (priv);
+}
+
+static void
+cattle_tape_dispose (GObject *object)
+{
+    CattleTape        *self;
+    CattleTapePrivate *priv;
+
+    self = CATTLE_TAPE (object);
+    priv = self->priv;
+
+    g_return_if_fail (!priv->disposed);
+
+    priv->disposed = TRUE;
+
+    G_OBJECT_CLASS (cattle_tape_parent_class)->dispose (object);
+}
+
+static void
+cattle_tape_finalize (GObject *object)
+{
+    CattleTape        *self;
+    CattleTapePrivate *priv;
+
+    self = CATTLE_TAPE (object);
+    priv = self->priv;
+
+    release_cells (priv->cells, priv->map, priv->map_size, priv->shared);
+    if (priv->pages != NULL)
+    {
+        g_hash_table_unref (priv->pages);
+    }
+    if (priv->bookmarks != priv->inline_bookmarks)
+    {
+        g_free (priv->bookmarks);
+    }
+
+    G_OBJECT_CLASS (cattle_tape_parent_class)->finalize (object);
+}
+
+/* Make sure there are at least @before cells on the left and @after
+ * cells on the right of the current one. The memory grows
+ * geometrically, so that moving in the same direction over and over
+ * only requires a logarithmic number of reallocations.
+ *
+ * Returns FALSE if the tape can't grow as much as requested */
+static gboolean
+grow (CattleTapePrivate *priv,
+      gulong             before,
+      gulong             after)
+{
+    guint8 *cells;
+    gulong  available;
+    gulong  needed_left;
+    gulong  needed_right;
+    gulong  left;
+    gulong  right;
+    gulong  room;
+    gulong  size;
+
+    needed_left = 0;
+    available = priv->current;
+    if (available < before)
+    {
+        needed_left = before - available;
+    }
+
+    needed_right = 0;
+    available = priv->size - priv->current - 1;
+    if (available < after)
+    {
+        needed_right = after - available;
+    }
+
+    if (needed_left == 0 && needed_right == 0)
+    {
+        return TRUE;
+    }
+
+    priv->limit_reached = FALSE;
+
+    /* Sparse tapes already span all possible indexes */
+    if (priv->fixed || priv->backend == CATTLE_TAPE_BACKEND_SPARSE)
+    {
+        return FALSE;
+    }
+
+    /* Growing modifies the cells, which must not be shared */
+    if (priv->shared != NULL)
+    {
+        unshare (priv, TRUE);
+    }
+
+    left = needed_left > 0 ? MAX (needed_left, priv->size) : 0;
+    right = needed_right > 0 ? MAX (needed_right, priv->size) : 0;
+
+    /* Number of cells that can be added without going over the
+     * memory limit */
+    room = G_MAXULONG;
+    if (priv->memory_limit > 0)
+    {
+        available = priv->memory_limit / priv->cell_size;
+        room = available > priv->size ? available - priv->size : 0;
+    }
+
+    /* Close to the limit, only grow as much as strictly needed */
+    if (left > room || right > room - left)
+    {
+        left = needed_left;
+        right = needed_right;
+
+        if (left > room || right > room - left)
+        {
+            priv->limit_reached = TRUE;
+
+            return FALSE;
+        }
+    }
+
+    if (priv->backend == CATTLE_TAPE_BACKEND_RESERVED)
+    {
+        /* Existing cells never move: more of the reserved range
+         * is committed around them instead */
+        if (!map_commit (priv, needed_left, needed_right, room, &left, &right))
+        {
+            return FALSE;
+        }
+
+        size = priv->size + left + right;
+        cells = priv->cells - left * priv->cell_size;
+    }
+    else if (left == 0)
+    {
+        /* Growing to the right only: existing cells stay where
+         * they are */
+        size = priv->size + right;
+        cells = g_realloc_n (priv->cells, size, priv->cell_size);
+        memset (cells + priv->size * priv->cell_size,
+                0,
+                right * priv->cell_size);
+    }
+    else
+    {
+        size = priv->size + left + right;
+        cells = g_malloc0_n (size, priv->cell_size);
+        memcpy (cells + left * priv->cell_size,
+                priv->cells,
+                priv->size * priv->cell_size);
+        g_free (priv->cells);
+    }
+
+    priv->cells = cells;
+    priv->size = size;
+
+    /* Indexes are shifted by the cells added on the left */
+    priv->origin += left;
+    priv->current += left;
+    priv->lower_limit += left;
+    priv->upper_limit += left;
+
+    update_peak_usage (priv);
+
+    return TRUE;
+}
+
+/* Intersect the @length cells starting @offset cells away from the
+ * current one with the valid cells of the tape. On return, the first
+ * @skip cells in the range come before the first valid cell, and the
+ * following @count cells, the first of which is at index @first, are
+ * valid */
+static void
+clip_range (CattleTapePrivate *priv,
+            glong              offset,
+            gulong             length,
+            gulong            *first,
+            gulong            *skip,
+            gulong            *count)
+{
+    glong lower;
+    glong upper;
+
+    lower = -(glong) (priv->current - priv->lower_limit);
+    upper = (glong) (priv->upper_limit - priv->current);
+
+    *first = 0;
+    *skip = 0;
+    *count = 0;
+
+    if (offset < lower)
+    {
+        /* Unsigned arithmetic can't overflow here */
+        *skip = (gulong) lower - (gulong) offset;
+
+        if (*skip >= length)
+        {
+            return;
+        }
+
+        offset = lower;
+    }
+
+    if (offset > upper)
+    {
+        return;
+    }
+
+    *first = priv->current + (gulong) offset;
+    *count = MIN (length - *skip, (gulong) upper - (gulong) offset + 1);
+}
+
+/* Copy @count cells, starting from the one at @index, from the tape to
+ * @data or, if @write is %TRUE, from @data to the tape. Cells in pages
+ * of a sparse tape that have not been allocated are not copied */
+static void
+copy_cells (CattleTapePrivate *priv,
+            gulong             index,
+            gulong             count,
+            guint8            *data,
+            gboolean           write)
+{
+    guint8 *cells;
+    gulong  chunk;
+    gsize   bytes;
+
+    if (priv->pages == NULL && write && priv->shared != NULL)
+    {
+        unshare (priv, TRUE);
+    }
+
+    while (count > 0)
+    {
+        if (priv->pages != NULL)
+        {
+            /* Stop at the end of the page */
+            chunk = (1UL << priv->page_shift) -
+                    (index & ((1UL << priv->page_shift) - 1));
+            chunk = MIN (chunk, count);
+            cells = sparse_lookup (priv, index, write);
+        }
+        else
+        {
+            chunk = count;
+            cells = CELL (priv, index);
+        }
+
+        bytes = chunk * priv->cell_size;
+
+        if (write)
+        {
+            memcpy (cells, data, bytes);
+        }
+        else if (cells != NULL)
+        {
+            memcpy (data, cells, bytes);
+        }
+
+        index += chunk;
+        count -= chunk;
+        data += bytes;
+    }
+}
+
+/* Make sure the bookmarks stack can contain at least @count bookmarks.
+ * The stack never shrinks, so once it's large enough no more
+ * allocations are performed */
+static void
+reserve_bookmarks (CattleTapePrivate *priv,
+                   gulong             count)
+{
+    glong *bookmarks;
+    guint  size;
+
+    if (count <= priv->max_bookmarks)
+    {
+        return;
+    }
+
+    size = priv->max_bookmarks;
+    while (size < count)
+    {
+        size *= 2;
+    }
+
+    bookmarks = g_new (glong, size);
+    memcpy (bookmarks,
+            priv->bookmarks,
+            priv->n_bookmarks * sizeof (glong));
+
+    if (priv->bookmarks != priv->inline_bookmarks)
+    {
+        g_free (priv->bookmarks);
+    }
+
+    priv->bookmarks = bookmarks;
+    priv->max_bookmarks = size;
+}
+
+/**
+ * cattle_tape_new:
+ *
+ * Create and initialize a new memory tape.
+ *
+ * Returns: (transfer full): a new #CattleTape
+ */
+CattleTape*
+cattle_tape_new (void)
+{
+    return g_object_new (CATTLE_TYPE_TAPE, NULL);
+}
+
+/**
+ * cattle_tape_new_with_size:
+ * @size: number of cells in the tape
+ *
+ * Create and initialize a new memory tape made of exactly @size cells.
+ *
+ * Unlike a tape created using cattle_tape_new(), the returned tape will
+ * not grow when moving past its edges: the current cell starts out as
+ * the first one, and the tape can't be moved to the left of it or more
+ * than @size - 1 cells to the right of it.
+ *
+ * Returns: (transfer full): a new #CattleTape
+ */
+CattleTape*
+cattle_tape_new_with_size (gulong size)
+{
+    g_return_val_if_fail (size > 0, NULL);
+
+    return g_object_new (CATTLE_TYPE_TAPE,
+                         "size",
+                         size,
+                         NULL);
+}
+
+/**
+ * cattle_tape_new_with_backend:
+ * @backend: a #CattleTapeBackend
+ *
+ * Create and initialize a new memory tape whose cells are allocated
+ * using @backend.
+ *
+ * If @backend is not available on the current platform, or the
+ * address space it needs can't be reserved, the default backend is
+ * used instead. Use cattle_tape_get_backend() to find out which one
+ * is actually in use.
+ *
+ * Returns: (transfer full): a new #CattleTape
+ */
+CattleTape*
+cattle_tape_new_with_backend (CattleTapeBackend backend)
+{
+    return g_object_new (CATTLE_TYPE_TAPE,
+                         "backend",
+                         backend,
+                         NULL);
+}
+
+/**
+ * cattle_tape_new_with_cell_width:
+ * @width: a #CattleCellWidth
+ *
+ * Create and initialize a new memory tape whose cells are @width
+ * bits wide.
+ *
+ * Returns: (transfer full): a new #CattleTape
+ */
+CattleTape*
+cattle_tape_new_with_cell_width (CattleCellWidth width)
+{
+    return g_object_new (CATTLE_TYPE_TAPE,
+                         "cell-width",
+                         width,
+                         NULL);
+}
+
+/**
+ * cattle_tape_snapshot:
+ * @tape: a #CattleTape
+ *
+ * Create a copy of @tape, including its contents, current position and
+ * bookmarks. Changes made to either tape don't affect the other one.
+ *
+ * The copy shares memory with @tape, so taking a snapshot is cheap,
+ * and memory is only copied when either tape is written to. How much
+ * is copied depends on the backend: tapes using
+ * %CATTLE_TAPE_BACKEND_SPARSE copy just the page containing the cell
+ * being written to, while tapes using any other backend copy all of
+ * their cells on the first write, which takes time proportional to the
+ * size of the tape.
+ *
+ * When a tape is going to be snapshotted many times, for example to
+ * explore several possible continuations of a computation, it should
+ * use %CATTLE_TAPE_BACKEND_SPARSE.
+ *
+ * Returns: (transfer full): a new #CattleTape
+ */
+CattleTape*
+cattle_tape_snapshot (CattleTape *self)
+{
+    CattleTapePrivate  *priv;
+    CattleTapePrivate  *copy_priv;
+    CattleTape         *copy;
+    GHashTableIter      iter;
+    gpointer            number;
+    gpointer            page;
+
+    g_return_val_if_fail (CATTLE_IS_TAPE (self), NULL);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, NULL);
+
+    /* Start from a default tape and replace its storage */
+    copy = g_object_new (CATTLE_TYPE_TAPE, NULL);
+    copy_priv = copy->priv;
+
+    release_cells (copy_priv->cells,
+                   copy_priv->map,
+                   copy_priv->map_size,
+                   copy_priv->shared);
+
+    copy_priv->width = priv->width;
+    copy_priv->cell_size = priv->cell_size;
+    copy_priv->backend = priv->backend;
+    copy_priv->fixed = priv->fixed;
+    copy_priv->left_growth = priv->left_growth;
+    copy_priv->memory_limit = priv->memory_limit;
+    copy_priv->size = priv->size;
+    copy_priv->origin = priv->origin;
+    copy_priv->current = priv->current;
+    copy_priv->lower_limit = priv->lower_limit;
+    copy_priv->upper_limit = priv->upper_limit;
+
+    if (priv->pages != NULL)
+    {
+        /* Share each page separately */
+        copy_priv->cells = NULL;
+        copy_priv->map = NULL;
+        copy_priv->map_size = 0;
+        copy_priv->shared = NULL;
+        copy_priv->pages = g_hash_table_new_full (g_direct_hash,
+                                                  g_direct_equal,
+                                                  NULL,
+                                                  (GDestroyNotify) sparse_page_unref);
+        copy_priv->page_shift = priv->page_shift;
+        copy_priv->cached = NULL;
+        copy_priv->sweep_limit = priv->sweep_limit;
+
+        g_hash_table_iter_init (&iter, priv->pages);
+        while (g_hash_table_iter_next (&iter, &number, &page))
+        {
+            g_hash_table_insert (copy_priv->pages,
+                                 number,
+                                 sparse_page_ref (page));
+        }
+    }
+    else
+    {
+        if (priv->shared == NULL)
+        {
+            priv->shared = g_new (gint, 1);
+            *(priv->shared) = 1;
+        }
+        g_atomic_int_inc (priv->shared);
+
+        copy_priv->cells = priv->cells;
+        copy_priv->map = priv->map;
+        copy_priv->map_size = priv->map_size;
+        copy_priv->huge_pages = priv->huge_pages;
+        copy_priv->shared = priv->shared;
+    }
+
+    /* Bookmarks are stored relative to the origin, which is the same
+     * for both tapes */
+    if (priv->n_bookmarks > copy_priv->max_bookmarks)
+    {
+        copy_priv->bookmarks = g_new (glong, priv->n_bookmarks);
+        copy_priv->max_bookmarks = priv->n_bookmarks;
+    }
+    memcpy (copy_priv->bookmarks,
+            priv->bookmarks,
+            priv->n_bookmarks * sizeof (glong));
+    copy_priv->n_bookmarks = priv->n_bookmarks;
+
+    /* Usage is counted as if memory was not shared */
+    copy_priv->peak_usage = 0;
+    update_peak_usage (copy_priv);
+
+    return copy;
+}
+
+/**
+ * cattle_tape_reset:
+ * @tape: a #CattleTape
+ *
+ * Restore @tape to its initial state, so that it can be reused to run
+ * another program: all cells are set to zero, the first one becomes
+ * the current one again and all bookmarks are removed.
+ *
+ * Unlike creating a new tape, resetting one keeps the memory it has
+ * already allocated, and only has to clear the cells that have been
+ * used. Settings such as the memory limit are not changed, while the
+ * peak memory usage starts being tracked again from the current usage.
+ */
+void
+cattle_tape_reset (CattleTape *self)
+{
+    CattleTapePrivate *priv;
+
+    g_return_if_fail (CATTLE_IS_TAPE (self));
+
+    priv = self->priv;
+    g_return_if_fail (!priv->disposed);
+
+    if (priv->pages != NULL)
+    {
+        /* Pages that only contain zeros don't need to exist at all */
+        g_hash_table_remove_all (priv->pages);
+        priv->cached = NULL;
+        priv->sweep_limit = SPARSE_SWEEP_LIMIT;
+    }
+    else
+    {
+        /* Don't clear cells other tapes are using */
+        if (priv->shared != NULL)
+        {
+            unshare (priv, FALSE);
+        }
+
+        /* Cells outside of the limits have never been written to */
+        memset (CELL (priv, priv->lower_limit),
+                0,
+                (priv->upper_limit - priv->lower_limit + 1) * priv->cell_size);
+    }
+
+    priv->current = priv->origin;
+    priv->lower_limit = priv->origin;
+    priv->upper_limit = priv->origin;
+
+    priv->n_bookmarks = 0;
+
+    priv->limit_reached = FALSE;
+    priv->peak_usage = 0;
+    update_peak_usage (priv);
+}
+
+/**
+ * cattle_tape_get_size:
+ * @tape: a #CattleTape
+ *
+ * Get the number of cells in @tape.
+ * See cattle_tape_new_with_size().
+ *
+ * Returns: the number of cells in @tape, or zero if @tape grows
+ * automatically as more cells are needed
+ */
+gulong
+cattle_tape_get_size (CattleTape *self)
+{
+    CattleTapePrivate *priv;
+
+    g_return_val_if_fail (CATTLE_IS_TAPE (self), 0);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, 0);
+
+    if (!priv->fixed)
+    {
+        return 0;
+    }
+
+    return priv->size;
+}
+
+/**
+ * cattle_tape_get_backend:
+ * @tape: a #CattleTape
+ *
+ * Get the backend used to allocate the cells of @tape.
+ * See cattle_tape_new_with_backend().
+ *
+ * Tapes with a fixed size always use %CATTLE_TAPE_BACKEND_HEAP.
+ *
+ * Returns: the backend used by @tape
+ */
+CattleTapeBackend
+cattle_tape_get_backend (CattleTape *self)
+{
+    CattleTapePrivate *priv;
+
+    g_return_val_if_fail (CATTLE_IS_TAPE (self), CATTLE_TAPE_BACKEND_HEAP);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, CATTLE_TAPE_BACKEND_HEAP);
+
+    return priv->backend;
+}
+
+/**
+ * cattle_tape_get_cell_width:
+ * @tape: a #CattleTape
+ *
+ * Get the width of the cells in @tape.
+ * See cattle_tape_new_with_cell_width().
+ *
+ * Returns: the width of the cells in @tape
+ */
+CattleCellWidth
+cattle_tape_get_cell_width (CattleTape *self)
+{
+    CattleTapePrivate *priv;
+
+    g_return_val_if_fail (CATTLE_IS_TAPE (self), CATTLE_CELL_WIDTH_8);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, CATTLE_CELL_WIDTH_8);
+
+    return priv->width;
+}
+
+/**
+ * cattle_tape_set_left_growth_is_enabled:
+ * @tape: a #CattleTape
+ * @enabled: %TRUE to allow @tape to grow on the left, %FALSE otherwise
+ *
+ * Set whether @tape is allowed to grow on the left. Left growth is
+ * enabled by default.
+ *
+ * If left growth is disabled, attempts to move to the left of the
+ * first cell of @tape, as reported by cattle_tape_is_at_beginning(),
+ * will fail; growth on the right is not affected. Unless @tape uses
+ * %CATTLE_TAPE_BACKEND_SPARSE, its cells are also moved to the
+ * beginning of the memory allocated for it, which makes all of that
+ * memory available for growing on the right and moving to the left
+ * faster.
+ */
+void
+cattle_tape_set_left_growth_is_enabled (CattleTape *self,
+                                        gboolean    enabled)
+{
+    CattleTapePrivate *priv;
+
+    g_return_if_fail (CATTLE_IS_TAPE (self));
+
+    priv = self->priv;
+    g_return_if_fail (!priv->disposed);
+
+    priv->left_growth = enabled;
+
+    if (!priv->left_growth)
+    {
+        rebase (priv);
+    }
+}
+
+/**
+ * cattle_tape_get_left_growth_is_enabled:
+ * @tape: a #CattleTape
+ *
+ * Get whether @tape is allowed to grow on the left.
+ * See cattle_tape_set_left_growth_is_enabled().
+ *
+ * Returns: %TRUE if left growth is enabled, %FALSE otherwise
+ */
+gboolean
+cattle_tape_get_left_growth_is_enabled (CattleTape *self)
+{
+    CattleTapePrivate *priv;
+
+    g_return_val_if_fail (CATTLE_IS_TAPE (self), FALSE);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, FALSE);
+
+    return priv->left_growth;
+}
+
+/**
+ * cattle_tape_set_huge_pages_are_enabled:
+ * @tape: a #CattleTape
+ * @enabled: %TRUE to back @tape with huge pages, %FALSE otherwise
+ *
+ * Set whether the memory used by @tape should be backed by huge pages.
+ * Huge pages are disabled by default.
+ *
+ * Tapes that grow very large and are scanned often benefit from huge
+ * pages, which reduce the number of TLB misses; on the other hand,
+ * memory is allocated in much larger blocks.
+ *
+ * Only tapes using the %CATTLE_TAPE_BACKEND_RESERVED backend can use
+ * huge pages, and only on platforms supporting them: in all other
+ * cases, calling this function has no effect. Use
+ * cattle_tape_get_huge_pages_are_enabled() to find out whether huge
+ * pages are actually being used.
+ */
+void
+cattle_tape_set_huge_pages_are_enabled (CattleTape *self,
+                                        gboolean    enabled)
+{
+    CattleTapePrivate *priv;
+
+    g_return_if_fail (CATTLE_IS_TAPE (self));
+
+    priv = self->priv;
+    g_return_if_fail (!priv->disposed);
+
+    if (priv->map == NULL)
+    {
+        return;
+    }
+
+#ifdef HUGE_PAGES_ARE_SUPPORTED
+    /* The advice applies to the whole reserved range, so memory
+     * committed later is covered as well */
+    if (madvise (priv->map,
+                 priv->map_size,
+                 enabled ? MADV_HUGEPAGE : MADV_NOHUGEPAGE) == 0)
+    {
+        priv->huge_pages = enabled;
+    }
+#else
+    (void) enabled;
+#endif
+}
+
+/**
+ * cattle_tape_get_huge_pages_are_enabled:
+ * @tape: a #CattleTape
+ *
+ * Get whether the memory used by @tape is backed by huge pages.
+ * See cattle_tape_set_huge_pages_are_enabled().
+ *
+ * Returns: %TRUE if @tape uses huge pages, %FALSE otherwise
+ */
+gboolean
+cattle_tape_get_huge_pages_are_enabled (CattleTape *self)
+{
+    CattleTapePrivate *priv;
+
+    g_return_val_if_fail (CATTLE_IS_TAPE (self), FALSE);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, FALSE);
+
+    return priv->huge_pages;
+}
+
+/**
+ * cattle_tape_set_memory_limit:
+ * @tape: a #CattleTape
+ * @limit: maximum number of bytes, or zero for no limit
+ *
+ * Set the maximum amount of memory, in bytes, @tape can use for its
+ * cells. There is no limit by default.
+ *
+ * Once the limit has been reached, attempts to move @tape to cells
+ * that would require more memory to be allocated will fail.
+ *
+ * Tapes with a fixed size have all their memory allocated at creation
+ * time, so they're not affected by the limit. Tapes using the
+ * %CATTLE_TAPE_BACKEND_SPARSE backend allocate memory one page at a
+ * time, and moving to a cell in a page that has not been allocated yet
+ * counts as allocating it.
+ *
+ * Setting a limit lower than the current memory usage doesn't cause
+ * any memory to be freed, but prevents @tape from growing further.
+ */
+void
+cattle_tape_set_memory_limit (CattleTape *self,
+                              gulong      limit)
+{
+    CattleTapePrivate *priv;
+
+    g_return_if_fail (CATTLE_IS_TAPE (self));
+
+    priv = self->priv;
+    g_return_if_fail (!priv->disposed);
+
+    priv->memory_limit = limit;
+}
+
+/**
+ * cattle_tape_get_memory_limit:
+ * @tape: a #CattleTape
+ *
+ * Get the maximum amount of memory @tape can use for its cells.
+ * See cattle_tape_set_memory_limit().
+ *
+ * Returns: the maximum number of bytes, or zero if there is no limit
+ */
+gulong
+cattle_tape_get_memory_limit (CattleTape *self)
+{
+    CattleTapePrivate *priv;
+
+    g_return_val_if_fail (CATTLE_IS_TAPE (self), 0);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, 0);
+
+    return priv->memory_limit;
+}
+
+/**
+ * cattle_tape_get_memory_usage:
+ * @tape: a #CattleTape
+ *
+ * Get the amount of memory currently used by the cells of @tape.
+ *
+ * Memory shared with snapshots is counted as if it belonged to @tape
+ * alone. See cattle_tape_snapshot().
+ *
+ * Returns: the number of bytes used by the cells of @tape
+ */
+gulong
+cattle_tape_get_memory_usage (CattleTape *self)
+{
+    CattleTapePrivate *priv;
+
+    g_return_val_if_fail (CATTLE_IS_TAPE (self), 0);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, 0);
+
+    return memory_usage (priv);
+}
+
+/**
+ * cattle_tape_get_peak_memory_usage:
+ * @tape: a #CattleTape
+ *
+ * Get the maximum amount of memory used by the cells of @tape at any
+ * point since it was created. See cattle_tape_get_memory_usage().
+ *
+ * Returns: the maximum number of bytes used by the cells of @tape
+ */
+gulong
+cattle_tape_get_peak_memory_usage (CattleTape *self)
+{
+    CattleTapePrivate *priv;
+
+    g_return_val_if_fail (CATTLE_IS_TAPE (self), 0);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, 0);
+
+    return priv->peak_usage;
+}
+
+/**
+ * cattle_tape_set_current_value:
+ * @tape: a #CattleTape
+ * @value: the current cell's new value
+ *
+ * Set the value of the current cell.
+ *
+ * Accepted values range from %G_MININT8 to %G_MAXINT8. If the cells
+ * of @tape are wider than 8 bits, @value is sign-extended; use
+ * cattle_tape_set_current_wide_value() to store larger values.
+ */
+void
+cattle_tape_set_current_value (CattleTape *self,
+                               gint8       value)
+{
+    CattleTapePrivate *priv;
+
+    g_return_if_fail (CATTLE_IS_TAPE (self));
+
+    priv = self->priv;
+    g_return_if_fail (!priv->disposed);
+
+    _cattle_cell_set (current_cell (priv, TRUE), value, priv->width);
+}
+
+/**
+ * cattle_tape_get_current_value:
+ * @tape: a #CattleTape
+ *
+ * Get the value of the current cell. See
+ * cattle_tape_set_current_value().
+ *
+ * If the cells of @tape are wider than 8 bits, only the lowest 8 bits
+ * of the value are returned; use cattle_tape_get_current_wide_value()
+ * to retrieve the full value.
+ *
+ * Returns: the value of the current cell
+ */
+gint8
+cattle_tape_get_current_value (CattleTape *self)
+{
+    CattleTapePrivate *priv;
+    guint8            *cell;
+
+    g_return_val_if_fail (CATTLE_IS_TAPE (self), 0);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, 0);
+
+    cell = current_cell (priv, FALSE);
+    if (cell == NULL)
+    {
+        return 0;
+    }
+
+    return (gint8) _cattle_cell_get (cell, priv->width);
+}
+
+/**
+ * cattle_tape_set_current_wide_value:
+ * @tape: a #CattleTape
+ * @value: the current cell's new value
+ *
+ * Set the value of the current cell.
+ *
+ * @value is truncated to the width of the cells of @tape, so for
+ * example only values ranging from %G_MININT16 to %G_MAXUINT16 can be
+ * stored in a tape with 16 bits wide cells.
+ */
+void
+cattle_tape_set_current_wide_value (CattleTape *self,
+                                    gint64      value)
+{
+    CattleTapePrivate *priv;
+
+    g_return_if_fail (CATTLE_IS_TAPE (self));
+
+    priv = self->priv;
+    g_return_if_fail (!priv->disposed);
+
+    _cattle_cell_set (current_cell (priv, TRUE), value, priv->width);
+}
+
+/**
+ * cattle_tape_get_current_wide_value:
+ * @tape: a #CattleTape
+ *
+ * Get the full value of the current cell, sign-extended to 64 bits.
+ * See cattle_tape_set_current_wide_value().
+ *
+ * Returns: the value of the current cell
+ */
+gint64
+cattle_tape_get_current_wide_value (CattleTape *self)
+{
+    CattleTapePrivate *priv;
+    guint8            *cell;
+
+    g_return_val_if_fail (CATTLE_IS_TAPE (self), 0);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, 0);
+
+    cell = current_cell (priv, FALSE);
+    if (cell == NULL)
+    {
+        return 0;
+    }
+
+    return _cattle_cell_get (cell, priv->width);
+}
+
+/**
+ * cattle_tape_increase_current_value:
+ * @tape: a #CattleTape
+ *
+ * Increase the value in the current cell by one.
+ */
+void
+cattle_tape_increase_current_value (CattleTape *self)
+{
+    cattle_tape_increase_current_value_by (self, 1);
+}
+
+/**
+ * cattle_tape_increase_current_value_by:
+ * @tape: a #CattleTape
+ * @value: increase amount
+ *
+ * Increase the value in the current cell by @value.
+ *
+ * Increasing the value this way is much faster than calling
+ * cattle_tape_increase_current_value() multiple times.
+ */
+void
+cattle_tape_increase_current_value_by (CattleTape *self,
+                                       gulong      value)
+{
+    CattleTapePrivate *priv;
+
+    g_return_if_fail (CATTLE_IS_TAPE (self));
+
+    priv = self->priv;
+    g_return_if_fail (!priv->disposed);
+
+    _cattle_cell_add (current_cell (priv, TRUE), value, priv->width);
+}
+
+/**
+ * cattle_tape_decrease_current_value:
+ * @tape: a #CattleTape
+ *
+ * Decrease the value in the current cell by one.
+ */
+void
+cattle_tape_decrease_current_value (CattleTape *self)
+{
+    cattle_tape_decrease_current_value_by (self, 1);
+}
+
+/**
+ * cattle_tape_decrease_current_value_by:
+ * @tape: a #CattleTape
+ * @value: decrease amount
+ *
+ * Decrease the value in the current cell by @value.
+ *
+ * Decreasing the value this way is much faster than calling
+ * cattle_tape_decrease_current_value() multiple times.
+ */
+void
+cattle_tape_decrease_current_value_by (CattleTape *self,
+                                       gulong      value)
+{
+    CattleTapePrivate *priv;
+
+    g_return_if_fail (CATTLE_IS_TAPE (self));
+
+    priv = self->priv;
+    g_return_if_fail (!priv->disposed);
+
+    _cattle_cell_add (current_cell (priv, TRUE),
+                      -(guint64) value,
+                      priv->width);
 }
 
-static void
-chunk_unref (gpointer chunk,
-             gpointer data G_GNUC_UNUSED)
+/**
+ * cattle_tape_move_left:
+ * @tape: a #CattleTape
+ *
+ * Move @tape one cell to the left.
+ *
+ * If there are no memory cells on the left of the current one,
+ * one will be created on the fly, unless @tape has a fixed size or
+ * can't grow on the left. See cattle_tape_move_left_by() for all the
+ * cases in which moving fails.
+ *
+ * Before Cattle 1.6, this function could not fail and didn't return
+ * any value.
+ *
+ * Returns: %TRUE on success, %FALSE if @tape could not be moved, in
+ * which case the current cell is not changed
+ */
+gboolean
+cattle_tape_move_left (CattleTape *self)
 {
-    g_object_unref (G_OBJECT (chunk));
+    return cattle_tape_move_left_by (self, 1);
 }
 
-static void
-cattle_tape_dispose (GObject *object)
+/**
+ * cattle_tape_move_left_by:
+ * @tape: a #CattleTape
+ * @steps: number of steps
+ *
+ * Move @tape @steps cells to the left.
+ *
+ * Moving this way is much faster than calling
+ * cattle_tape_move_left() multiple times.
+ *
+ * If @tape has a fixed size or can't grow on the left, and there are
+ * less than @steps cells on the left of the current one, the tape is
+ * not moved at all. The same happens if growing @tape would take it
+ * over its memory limit, see cattle_tape_set_memory_limit(), or if
+ * @tape uses the %CATTLE_TAPE_BACKEND_RESERVED backend and has run out
+ * of reserved address space.
+ *
+ * Before Cattle 1.6, this function could not fail and didn't return
+ * any value.
+ *
+ * Returns: %TRUE on success, %FALSE if @tape could not be moved, in
+ * which case the current cell is not changed
+ */
+gboolean
+cattle_tape_move_left_by (CattleTape *self,
+                          gulong      steps)
 {
-    CattleTape        *self;
     CattleTapePrivate *priv;
 
-    self = CATTLE_TAPE (object);
+    g_return_val_if_fail (CATTLE_IS_TAPE (self), FALSE);
+
     priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, FALSE);
 
-    g_return_if_fail (!priv->disposed);
+    /* When the tape can't grow on the left, the first valid cell is
+     * as far as it can go, and the lower limit never changes */
+    if (G_UNLIKELY (!priv->left_growth))
+    {
+        if (steps > priv->current - priv->lower_limit)
+        {
+            priv->limit_reached = FALSE;
 
-    g_list_foreach (priv->head, (GFunc) chunk_unref, NULL);
+            return FALSE;
+        }
 
-    priv->disposed = TRUE;
+        /* Moving to a page that doesn't exist counts as growing */
+        if (G_UNLIKELY (priv->pages != NULL) &&
+            !sparse_reserve (priv, priv->current - steps, 1))
+        {
+            return FALSE;
+        }
 
-    G_OBJECT_CLASS (cattle_tape_parent_class)->dispose (object);
-}
+        priv->current -= steps;
 
-static void
-bookmark_free (gpointer bookmark,
-               gpointer data G_GNUC_UNUSED)
-{
-    g_free (bookmark);
-}
+        return TRUE;
+    }
 
-static void
-cattle_tape_finalize (GObject *object)
-{
-    CattleTape        *self;
-    CattleTapePrivate *priv;
+    /* Make room on the left if needed */
+    if (steps > priv->current)
+    {
+        /* Fixed-size tapes can't grow, and reserved ones can run out
+         * of reserved address space */
+        if (G_UNLIKELY (!grow (priv, steps, 0)))
+        {
+            return FALSE;
+        }
+    }
 
-    self = CATTLE_TAPE (object);
-    priv = self->priv;
+    /* Moving to a page that doesn't exist counts as growing */
+    if (G_UNLIKELY (priv->pages != NULL) &&
+        !sparse_reserve (priv, priv->current - steps, 1))
+    {
+        return FALSE;
+    }
 
-    g_slist_foreach (priv->bookmarks, (GFunc) bookmark_free, NULL);
+    priv->current -= steps;
 
-    g_list_free (priv->head);
-    g_slist_free (priv->bookmarks);
+    /* The lower limit might need to be updated */
+    if (priv->current < priv->lower_limit)
+    {
+        priv->lower_limit = priv->current;
+    }
 
-    G_OBJECT_CLASS (cattle_tape_parent_class)->finalize (object);
+    return TRUE;
 }
 
 /**
- * cattle_tape_new:
+ * cattle_tape_move_right:
+ * @tape: a #CattleTape
  *
- * Create and initialize a new memory tape.
+ * Move @tape one cell to the right.
  *
- * Returns: (transfer full): a new #CattleTape
+ * If there are no memory cells on the right of the current one,
+ * one will be created on the fly, unless @tape has a fixed size.
+ * See cattle_tape_move_right_by() for all the cases in which moving
+ * fails.
+ *
+ * Before Cattle 1.6, this function could not fail and didn't return
+ * any value.
+ *
+ * Returns: %TRUE on success, %FALSE if @tape could not be moved, in
+ * which case the current cell is not changed
  */
-CattleTape*
-cattle_tape_new (void)
+gboolean
+cattle_tape_move_right (CattleTape *self)
 {
-    return g_object_new (CATTLE_TYPE_TAPE, NULL);
+    return cattle_tape_move_right_by (self, 1);
 }
 
 /**
- * cattle_tape_set_current_value:
+ * cattle_tape_move_right_by:
  * @tape: a #CattleTape
- * @value: the current cell's new value
+ * @steps: number of steps
  *
- * Set the value of the current cell.
+ * Move @tape @steps cells to the right.
  *
- * Accepted values range from %G_MININT8 to %G_MAXINT8.
+ * Moving this way is much faster than calling
+ * cattle_tape_move_right() multiple times.
+ *
+ * If @tape has a fixed size and there are less than @steps cells on
+ * the right of the current one, the tape is not moved at all. The same
+ * happens if growing @tape would take it over its memory limit, see
+ * cattle_tape_set_memory_limit(), or if @tape uses the
+ * %CATTLE_TAPE_BACKEND_RESERVED backend and has run out of reserved
+ * address space.
+ *
+ * Before Cattle 1.6, this function could not fail and didn't return
+ * any value.
+ *
+ * Returns: %TRUE on success, %FALSE if @tape could not be moved, in
+ * which case the current cell is not changed
  */
-void
-cattle_tape_set_current_value (CattleTape *self,
-                               gint8       value)
+gboolean
+cattle_tape_move_right_by (CattleTape *self,
+                           gulong      steps)
 {
     CattleTapePrivate *priv;
-    CattleBuffer      *chunk;
 
-    g_return_if_fail (CATTLE_IS_TAPE (self));
+    g_return_val_if_fail (CATTLE_IS_TAPE (self), FALSE);
 
     priv = self->priv;
-    g_return_if_fail (!priv->disposed);
+    g_return_val_if_fail (!priv->disposed, FALSE);
+
+    /* Make room on the right if needed */
+    if (steps >= priv->size - priv->current)
+    {
+        /* Fixed-size tapes can't grow, and reserved ones can run out
+         * of reserved address space */
+        if (G_UNLIKELY (!grow (priv, 0, steps)))
+        {
+            return FALSE;
+        }
+    }
+
+    /* Moving to a page that doesn't exist counts as growing */
+    if (G_UNLIKELY (priv->pages != NULL) &&
+        !sparse_reserve (priv, priv->current + steps, 1))
+    {
+        return FALSE;
+    }
+
+    priv->current += steps;
 
-    chunk = CATTLE_BUFFER (priv->current->data);
+    /* The upper limit might need to be updated */
+    if (priv->current > priv->upper_limit)
+    {
+        priv->upper_limit = priv->current;
+    }
 
-    cattle_buffer_set_value (chunk, priv->offset, value);
+    return TRUE;
 }
 
 /**
- * cattle_tape_get_current_value:
+ * cattle_tape_reserve:
  * @tape: a #CattleTape
+ * @before: number of cells needed on the left of the current one
+ * @after: number of cells needed on the right of the current one
  *
- * Get the value of the current cell. See
- * cattle_tape_set_current_value().
+ * Make sure @tape has enough memory to move @before cells to the left
+ * and @after cells to the right of the current cell without having to
+ * allocate more memory.
  *
- * Returns: the value of the current cell
+ * Reserving memory doesn't change the contents of @tape, nor the
+ * results of cattle_tape_is_at_beginning() and cattle_tape_is_at_end().
+ *
+ * Tapes with a fixed size have all their memory allocated at creation
+ * time, so calling this function on them has no effect.
  */
-gint8
-cattle_tape_get_current_value (CattleTape *self)
+void
+cattle_tape_reserve (CattleTape *self,
+                     gulong      before,
+                     gulong      after)
 {
     CattleTapePrivate *priv;
-    CattleBuffer      *chunk;
 
-    g_return_val_if_fail (CATTLE_IS_TAPE (self), 0);
+    g_return_if_fail (CATTLE_IS_TAPE (self));
 
     priv = self->priv;
-    g_return_val_if_fail (!priv->disposed, 0);
+    g_return_if_fail (!priv->disposed);
+
+    if (priv->fixed)
+    {
+        return;
+    }
 
-    chunk = CATTLE_BUFFER (priv->current->data);
+    /* No cells will ever be needed on the left of the first one */
+    if (!priv->left_growth)
+    {
+        before = MIN (before, priv->current - priv->lower_limit);
+    }
 
-    return cattle_buffer_get_value (chunk, priv->offset);
+    grow (priv, before, after);
 }
 
 /**
- * cattle_tape_increase_current_value:
+ * cattle_tape_is_at_beginning:
  * @tape: a #CattleTape
  *
- * Increase the value in the current cell by one.
- */
-void
-cattle_tape_increase_current_value (CattleTape *self)
-{
-    cattle_tape_increase_current_value_by (self, 1);
-}
-
-/**
- * cattle_tape_increase_current_value_by:
- * @tape: a #CattleTape
- * @value: increase amount
+ * Check if the current cell is the first one of @tape.
  *
- * Increase the value in the current cell by @value.
+ * Tapes grow automatically as more cells are needed, so it's usually
+ * possible to move left from the first cell. That's not the case if
+ * @tape has a fixed size, can't grow on the left, or has reached its
+ * memory limit: see cattle_tape_move_left_by().
  *
- * Increasing the value this way is much faster than calling
- * cattle_tape_increase_current_value() multiple times.
+ * Returns: %TRUE if the current cell is the first one, %FALSE otherwise
  */
-void
-cattle_tape_increase_current_value_by (CattleTape *self,
-                                       gulong      value)
+gboolean
+cattle_tape_is_at_beginning (CattleTape *self)
 {
     CattleTapePrivate *priv;
-    CattleBuffer      *chunk;
-    gint8              current;
+    gboolean           check;
 
-    g_return_if_fail (CATTLE_IS_TAPE (self));
+    g_return_val_if_fail (CATTLE_IS_TAPE (self), FALSE);
 
     priv = self->priv;
-    g_return_if_fail (!priv->disposed);
+    g_return_val_if_fail (!priv->disposed, FALSE);
 
-    /* Return right away if no increment is needed */
-    if (value == 0)
+    /* If the current cell is the first valid one, we are at the
+     * beginning of the tape */
+    if (priv->current == priv->lower_limit)
     {
-        return;
+        check = TRUE;
+    }
+    else
+    {
+        check = FALSE;
     }
 
-    chunk = CATTLE_BUFFER (priv->current->data);
-
-    current = cattle_buffer_get_value (chunk, priv->offset);
-    cattle_buffer_set_value (chunk, priv->offset, current + value);
+    return check;
 }
 
 /**
- * cattle_tape_decrease_current_value:
+ * cattle_tape_is_at_end:
  * @tape: a #CattleTape
  *
- * Decrease the value in the current cell by one.
+ * Check if the current cell is the last one of @tape.
+ *
+ * Tapes grow automatically as more cells are needed, so it's usually
+ * possible to move right from the last cell. That's not the case if
+ * @tape has a fixed size or has reached its memory limit: see
+ * cattle_tape_move_right_by().
+ *
+ * Returns: %TRUE if the current cell is the last one, %FALSE otherwise
  */
-void
-cattle_tape_decrease_current_value (CattleTape *self)
+gboolean
+cattle_tape_is_at_end (CattleTape *self)
 {
-    cattle_tape_decrease_current_value_by (self, 1);
+    CattleTapePrivate *priv;
+    gboolean           check;
+
+    g_return_val_if_fail (CATTLE_IS_TAPE (self), FALSE);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, FALSE);
+
+    /* If the current cell is the last valid one, we are in the
+     * last valid position */
+    if (priv->current == priv->upper_limit)
+    {
+        check = TRUE;
+    }
+    else
+    {
+        check = FALSE;
+    }
+
+    return check;
 }
 
 /**
- * cattle_tape_decrease_current_value_by:
+ * cattle_tape_get_range:
  * @tape: a #CattleTape
- * @value: decrease amount
+ * @offset: position of the first cell, relative to the current one
+ * @length: number of cells
+ * @data: (out caller-allocates): return location for the values
  *
- * Decrease the value in the current cell by @value.
+ * Copy the values of @length cells, starting @offset cells away from
+ * the current one, to @data. A negative @offset refers to cells on the
+ * left of the current one.
  *
- * Decreasing the value this way is much faster than calling
- * cattle_tape_decrease_current_value() multiple times.
+ * @data must be large enough to contain @length cells; each cell takes
+ * as many bytes as needed to store cattle_tape_get_cell_width() bits,
+ * and values are stored in host byte order.
+ *
+ * Cells that don't exist yet have a value of zero. Neither the
+ * position nor the size of @tape are changed.
  */
 void
-cattle_tape_decrease_current_value_by (CattleTape *self,
-                                       gulong      value)
+cattle_tape_get_range (CattleTape *self,
+                       glong       offset,
+                       gulong      length,
+                       gpointer    data)
 {
     CattleTapePrivate *priv;
-    CattleBuffer      *chunk;
-    gint8              current;
+    gulong             first;
+    gulong             skip;
+    gulong             count;
 
     g_return_if_fail (CATTLE_IS_TAPE (self));
+    g_return_if_fail (data != NULL || length == 0);
 
     priv = self->priv;
     g_return_if_fail (!priv->disposed);
 
-    /* Return right away if no decrement is needed */
-    if (value == 0)
+    if (length == 0)
     {
         return;
     }
 
-    chunk = CATTLE_BUFFER (priv->current->data);
+    memset (data, 0, length * priv->cell_size);
 
-    current = cattle_buffer_get_value (chunk, priv->offset);
-    cattle_buffer_set_value (chunk, priv->offset, current - value);
+    clip_range (priv, offset, length, &first, &skip, &count);
+    copy_cells (priv,
+                first,
+                count,
+                (guint8 *) data + skip * priv->cell_size,
+                FALSE);
 }
 
 /**
- * cattle_tape_move_left:
+ * cattle_tape_set_range:
  * @tape: a #CattleTape
+ * @offset: position of the first cell, relative to the current one
+ * @length: number of cells
+ * @data: (in): the values
  *
- * Move @tape one cell to the left.
+ * Copy the values of @length cells from @data to @tape, starting
+ * @offset cells away from the current one. See cattle_tape_get_range()
+ * for the layout of @data.
  *
- * If there are no memory cells on the left of the current one,
- * one will be created on the fly.
+ * @tape grows as needed to contain all cells, as if it had been moved
+ * to each one of them in turn, but the current position is not changed.
+ *
+ * Returns: %TRUE on success, %FALSE if @tape could not grow enough to
+ * contain all cells, in which case it has not been changed
  */
-void
-cattle_tape_move_left (CattleTape *self)
+gboolean
+cattle_tape_set_range (CattleTape    *self,
+                       glong          offset,
+                       gulong         length,
+                       gconstpointer  data)
 {
-    cattle_tape_move_left_by (self, 1);
+    CattleTapePrivate *priv;
+    gulong             before;
+    gulong             after;
+
+    g_return_val_if_fail (CATTLE_IS_TAPE (self), FALSE);
+    g_return_val_if_fail (data != NULL || length == 0, FALSE);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, FALSE);
+
+    if (length == 0)
+    {
+        return TRUE;
+    }
+
+    /* The position of the last cell must be representable */
+    if (length - 1 > (gulong) (G_MAXLONG - MAX (offset, 0)))
+    {
+        return FALSE;
+    }
+
+    before = offset < 0 ? 0UL - (gulong) offset : 0;
+    after = offset + (glong) (length - 1) > 0 ?
+            (gulong) (offset + (glong) (length - 1)) : 0;
+
+    /* Same rules as cattle_tape_move_left_by() */
+    if (!priv->left_growth && before > priv->current - priv->lower_limit)
+    {
+        return FALSE;
+    }
+
+    if (G_UNLIKELY (!grow (priv, before, after)))
+    {
+        return FALSE;
+    }
+
+    if (priv->pages != NULL &&
+        !sparse_reserve (priv, priv->current + (gulong) offset, length))
+    {
+        return FALSE;
+    }
+
+    copy_cells (priv,
+                priv->current + (gulong) offset,
+                length,
+                (guint8 *) data,
+                TRUE);
+
+    /* The written cells are now valid */
+    priv->lower_limit = MIN (priv->lower_limit, priv->current - before);
+    priv->upper_limit = MAX (priv->upper_limit, priv->current + after);
+
+    return TRUE;
 }
 
 /**
- * cattle_tape_move_left_by:
+ * cattle_tape_peek_range:
  * @tape: a #CattleTape
- * @steps: number of steps
+ * @offset: position of the first cell, relative to the current one
+ * @length: number of cells
  *
- * Move @tape @steps cells to the left.
+ * Get direct, read-only access to the values of @length cells,
+ * starting @offset cells away from the current one, without copying
+ * them. See cattle_tape_get_range() for the layout of the values.
  *
- * Moving this way is much faster than calling
- * cattle_tape_move_left() multiple times.
+ * This is only possible if the cells are stored contiguously in
+ * memory: it always is for valid cells of tapes using the
+ * %CATTLE_TAPE_BACKEND_HEAP and %CATTLE_TAPE_BACKEND_RESERVED backends,
+ * while for tapes using the %CATTLE_TAPE_BACKEND_SPARSE backend the
+ * cells must all be in the same page. Use cattle_tape_get_range()
+ * when %NULL is returned.
+ *
+ * The returned memory is only valid until @tape is next modified,
+ * moved or destroyed.
+ *
+ * Returns: (transfer none) (nullable): the values of the cells, or
+ * %NULL if they're not all valid or not stored contiguously
  */
-void
-cattle_tape_move_left_by (CattleTape *self,
-                          gulong      steps)
+gconstpointer
+cattle_tape_peek_range (CattleTape *self,
+                        glong       offset,
+                        gulong      length)
 {
-    CattleTapePrivate *priv;
-    CattleBuffer      *chunk;
+    static const guint64  zeros[SPARSE_PAGE_SIZE / sizeof (guint64)];
+    CattleTapePrivate    *priv;
+    const guint8         *cells;
+    gulong                first;
+    gulong                skip;
+    gulong                count;
+    gulong                mask;
+
+    g_return_val_if_fail (CATTLE_IS_TAPE (self), NULL);
+    g_return_val_if_fail (length > 0, NULL);
+
+    priv = self->priv;
+    g_return_val_if_fail (!priv->disposed, NULL);
+
+    clip_range (priv, offset, length, &first, &skip, &count);
+
+    if (skip > 0 || count < length)
+    {
+        return NULL;
+    }
 
-    g_return_if_fail (CATTLE_IS_TAPE (self));
+    if (priv->pages == NULL)
+    {
+        return CELL (priv, first);
+    }
 
-    priv = self->priv;
-    g_return_if_fail (!priv->disposed);
+    /* The first and last cells must be in the same page */
+    mask = ~((1UL << priv->page_shift) - 1);
+    if ((first & mask) != ((first + length - 1) & mask))
+    {
+        return NULL;
+    }
+
+    cells = sparse_lookup (priv, first, FALSE);
 
-    /* Move backwards until the correct chunk is found */
-    while (steps > priv->offset)
+    /* Pages that have not been allocated only contain zeros */
+    if (cells == NULL)
     {
-        /* If there is no previous chunk, create it */
-        if (g_list_previous (priv->current) == NULL)
+        return zeros;
+    }
+
+    return cells;
+}
+
+/* Write all @size bytes in @data to @fd, retrying on short writes */
+static gboolean
+write_all (gint          fd,
+           gconstpointer data,
+           gsize         size)
+{
+    const guint8 *next;
+    gssize        written;
+
+    next = data;
+    while (size > 0)
+    {
+        written = write (fd, next, size);
+        if (written < 0)
         {
-            chunk = cattle_buffer_new (CHUNK_SIZE);
-            priv->head = g_list_prepend (priv->head, chunk);
-            priv->lower_limit = CHUNK_SIZE - 1;
-        }
+            if (errno == EINTR)
+            {
+                continue;
+            }
 
-        priv->current = g_list_previous (priv->current);
+            return FALSE;
+        }
 
-        steps -= (priv->offset + 1);
-        priv->offset = CHUNK_SIZE - 1;
+        next += written;
+        size -= written;
     }
 
-    priv->offset -= steps;
+    return TRUE;
+}
+
+/* Read exactly @size bytes from @fd into @data, starting at @offset */
+static gboolean
+read_all (gint     fd,
+          gpointer data,
+          gsize    size,
+          off_t    offset)
+{
+    guint8 *next;
+    gssize  count;
 
-    /* If the current chunk is the first one, the lower limit
-     * might need to be updated */
-    if (g_list_previous (priv->current) == NULL)
+    next = data;
+    while (size > 0)
     {
-        if (priv->offset < priv->lower_limit)
+        count = pread (fd, next, size, offset);
+        if (count < 0 && errno == EINTR)
         {
-            priv->lower_limit = priv->offset;
+            continue;
         }
+        if (count <= 0)
+        {
+            /* Files shorter than expected are not valid */
+            if (count == 0)
+            {
+                errno = EINVAL;
+            }
+
+            return FALSE;
+        }
+
+        next += count;
+        size -= count;
+        offset += count;
     }
+
+    return TRUE;
 }
 
 /**
- * cattle_tape_move_right:
+ * cattle_tape_save:
  * @tape: a #CattleTape
+ * @filename: (type filename): name of the file
+ * @error: return location for a #GError
  *
- * Move @tape one cell to the right.
+ * Save the state of @tape, that is the values of its cells, its current
+ * position and its bookmarks, to @filename, which is overwritten if it
+ * already exists. The state can be restored later using
+ * cattle_tape_load().
  *
- * If there are no memory cells on the right of the current one,
- * one will be created on the fly.
- */
-void
-cattle_tape_move_right (CattleTape *self)
-{
-    cattle_tape_move_right_by (self, 1);
-}
-
-/**
- * cattle_tape_move_right_by:
- * @tape: a #CattleTape
- * @steps: number of steps
+ * The state is first written to a temporary file in the same directory
+ * as @filename, which then replaces @filename: if saving fails, or is
+ * interrupted, the previous contents of @filename are left untouched.
+ * This also makes it safe to save a tape to the same file it was
+ * loaded from.
  *
- * Move @tape @steps cells to the right.
+ * The file is stored in a compact binary format, which is only
+ * guaranteed to be understood by the same version of Cattle running
+ * on the same architecture.
  *
- * Moving this way is much faster than calling
- * cattle_tape_move_right() multiple times.
+ * Returns: %TRUE on success, %FALSE otherwise
  */
-void
-cattle_tape_move_right_by (CattleTape *self,
-                           gulong      steps)
+gboolean
+cattle_tape_save (CattleTape   *self,
+                  const gchar  *filename,
+                  GError      **error)
 {
     CattleTapePrivate *priv;
-    CattleBuffer      *chunk;
+    TapeFileTrailer    trailer;
+    guint8            *buffer;
+    gchar             *temporary;
+    gint64             bookmark;
+    gulong             length;
+    gulong             index;
+    gulong             count;
+    gboolean           success;
+    guint              i;
+    gint               fd;
 
-    g_return_if_fail (CATTLE_IS_TAPE (self));
+    g_return_val_if_fail (CATTLE_IS_TAPE (self), FALSE);
+    g_return_val_if_fail (filename != NULL, FALSE);
+    g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
     priv = self->priv;
-    g_return_if_fail (!priv->disposed);
+    g_return_val_if_fail (!priv->disposed, FALSE);
+
+    /* Never write to @filename directly: a reserved tape might be
+     * mapped from it, and a failed save would destroy the previous
+     * state. The temporary file is in the same directory, so that it
+     * can be renamed over @filename */
+    temporary = g_strdup_printf ("%s.XXXXXX", filename);
 
-    /* Move forward until the correct chunk is found */
-    while (priv->offset + steps >= CHUNK_SIZE )
+    fd = g_mkstemp_full (temporary, O_WRONLY, 0666);
+    if (fd < 0)
     {
-        /* If there is no next chunk, create it */
-        if (g_list_next (priv->current) == NULL)
-        {
-            chunk = cattle_buffer_new (CHUNK_SIZE);
-            priv->head = g_list_append (priv->head, chunk);
-            priv->upper_limit = 0;
-        }
+        g_set_error (error,
+                     CATTLE_ERROR,
+                     CATTLE_ERROR_IO,
+                     "%s: %s",
+                     filename,
+                     strerror (errno));
 
-        priv->current = g_list_next (priv->current);
+        g_free (temporary);
 
-        steps -= (CHUNK_SIZE - priv->offset);
-        priv->offset = 0;
+        return FALSE;
     }
 
-    priv->offset += steps;
+    length = priv->upper_limit - priv->lower_limit + 1;
 
-    /* If the current chunk is the last one, the upper limit
-     * might need to be updated */
-    if (g_list_next (priv->current) == NULL)
+    if (priv->pages == NULL)
     {
-        if (priv->offset > priv->upper_limit)
+        /* Valid cells are contiguous */
+        success = write_all (fd,
+                             CELL (priv, priv->lower_limit),
+                             length * priv->cell_size);
+    }
+    else
+    {
+        /* Copy cells a page at a time, zeros included */
+        buffer = g_malloc (SPARSE_PAGE_SIZE);
+        success = TRUE;
+        for (index = priv->lower_limit;
+             success && index - priv->lower_limit < length;
+             index += count)
         {
-            priv->upper_limit = priv->offset;
+            count = MIN (length - (index - priv->lower_limit),
+                         SPARSE_PAGE_SIZE / priv->cell_size);
+            memset (buffer, 0, count * priv->cell_size);
+            copy_cells (priv, index, count, buffer, FALSE);
+            success = write_all (fd, buffer, count * priv->cell_size);
         }
+        g_free (buffer);
+    }
+
+    for (i = 0; success && i < priv->n_bookmarks; i++)
+    {
+        bookmark = priv->bookmarks[i];
+        success = write_all (fd, &bookmark, sizeof (bookmark));
+    }
+
+    if (success)
+    {
+        memset (&trailer, 0, sizeof (trailer));
+        memcpy (trailer.magic, TAPE_FILE_MAGIC, sizeof (TAPE_FILE_MAGIC));
+        trailer.version = TAPE_FILE_VERSION;
+        trailer.width = priv->width;
+        trailer.length = length;
+        trailer.current = (gint64) (priv->current - priv->lower_limit);
+        trailer.origin = (gint64) (priv->origin - priv->lower_limit);
+        trailer.n_bookmarks = priv->n_bookmarks;
+
+        success = write_all (fd, &trailer, sizeof (trailer));
+    }
+
+    /* Make sure the contents are on disk before they replace the
+     * previous ones */
+    if (success)
+    {
+        success = (fsync (fd) == 0);
     }
+
+    if (!success)
+    {
+        g_set_error (error,
+                     CATTLE_ERROR,
+                     CATTLE_ERROR_IO,
+                     "%s: %s",
+                     filename,
+                     strerror (errno));
+
+        close (fd);
+        unlink (temporary);
+        g_free (temporary);
+
+        return FALSE;
+    }
+
+    if (close (fd) != 0 || rename (temporary, filename) != 0)
+    {
+        g_set_error (error,
+                     CATTLE_ERROR,
+                     CATTLE_ERROR_IO,
+                     "%s: %s",
+                     filename,
+                     strerror (errno));
+
+        unlink (temporary);
+        g_free (temporary);
+
+        return FALSE;
+    }
+
+    g_free (temporary);
+
+    return TRUE;
 }
 
 /**
- * cattle_tape_is_at_beginning:
+ * cattle_tape_load:
  * @tape: a #CattleTape
+ * @filename: (type filename): name of the file
+ * @error: return location for a #GError
  *
- * Check if the current cell is the first one of @tape.
+ * Restore the state of @tape from @filename, which must have been
+ * created using cattle_tape_save() from a tape with the same cell
+ * width as @tape. The previous contents of @tape are discarded.
  *
- * Since the tape grows automatically as more cells are needed, it is
- * possible to move left from the first cell.
+ * Cells are placed in @tape the same way they were placed in the
+ * original tape, so loading fails if @tape has a fixed size or can't
+ * grow on the left and they don't fit; it also fails, with a
+ * %CATTLE_ERROR_TAPE_MEMORY_LIMIT error, if they would take @tape
+ * over its memory limit.
  *
- * Returns: %TRUE if the current cell is the first one, %FALSE otherwise
+ * Tapes using the %CATTLE_TAPE_BACKEND_RESERVED backend map @filename
+ * into memory instead of reading it: pages are then only read from
+ * the file when they're accessed, and copied when they're first
+ * modified. @filename must not be modified or truncated for as long
+ * as @tape is using it; replacing it, as cattle_tape_save() does, is
+ * safe. Huge pages are still used for the mapped cells if they were
+ * enabled for @tape, see cattle_tape_set_huge_pages_are_enabled().
+ *
+ * If loading fails, @tape is left in the same state as after calling
+ * cattle_tape_reset().
+ *
+ * Returns: %TRUE on success, %FALSE otherwise
  */
 gboolean
-cattle_tape_is_at_beginning (CattleTape *self)
+cattle_tape_load (CattleTape   *self,
+                  const gchar  *filename,
+                  GError      **error)
 {
     CattleTapePrivate *priv;
-    gboolean           check;
+    TapeFileTrailer    trailer;
+    struct stat        info;
+    guint8            *buffer;
+    gint64            *bookmarks;
+    gsize              bytes;
+    gulong             index;
+    gulong             count;
+    gboolean           success;
+    gboolean           read_failed;
+    guint64            i;
+    gint               fd;
 
     g_return_val_if_fail (CATTLE_IS_TAPE (self), FALSE);
+    g_return_val_if_fail (filename != NULL, FALSE);
+    g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
     priv = self->priv;
     g_return_val_if_fail (!priv->disposed, FALSE);
 
-    /* If the current chunk is the first one and the current offset
-     * is equal to the lower limit, we are at the beginning of the
-     * tape */
-    if (g_list_previous (priv->current) == NULL && (priv->offset == priv->lower_limit))
+    fd = open (filename, O_RDONLY);
+    if (fd < 0 ||
+        fstat (fd, &info) != 0 ||
+        info.st_size < (off_t) sizeof (trailer) ||
+        !read_all (fd,
+                   &trailer,
+                   sizeof (trailer),
+                   info.st_size - sizeof (trailer)))
     {
-        check = TRUE;
+        g_set_error (error,
+                     CATTLE_ERROR,
+                     CATTLE_ERROR_IO,
+                     "%s: %s",
+                     filename,
+                     strerror (errno));
+
+        if (fd >= 0)
+        {
+            close (fd);
+        }
+
+        return FALSE;
     }
-    else
+
+    /* Make sure the trailer describes the file accurately before
+     * trusting it */
+    bytes = trailer.length * priv->cell_size;
+    if (memcmp (trailer.magic, TAPE_FILE_MAGIC, sizeof (TAPE_FILE_MAGIC)) != 0 ||
+        trailer.version != TAPE_FILE_VERSION ||
+        trailer.width != (guint32) priv->width ||
+        trailer.length == 0 ||
+        trailer.length > G_MAXLONG / priv->cell_size ||
+        trailer.n_bookmarks > G_MAXUINT / 2 ||
+        trailer.current < 0 || (guint64) trailer.current >= trailer.length ||
+        trailer.origin < 0 || (guint64) trailer.origin >= trailer.length ||
+        (guint64) info.st_size != bytes +
+                                  trailer.n_bookmarks * sizeof (gint64) +
+                                  sizeof (trailer))
     {
-        check = FALSE;
+        g_set_error (error,
+                     CATTLE_ERROR,
+                     CATTLE_ERROR_IO,
+                     "%s: Not a valid tape file",
+                     filename);
+
+        close (fd);
+
+        return FALSE;
     }
 
-    return check;
-}
+    bookmarks = g_new (gint64, trailer.n_bookmarks);
+    if (!read_all (fd,
+                   bookmarks,
+                   trailer.n_bookmarks * sizeof (gint64),
+                   bytes))
+    {
+        g_set_error (error,
+                     CATTLE_ERROR,
+                     CATTLE_ERROR_IO,
+                     "%s: %s",
+                     filename,
+                     strerror (errno));
 
-/**
- * cattle_tape_is_at_end:
- * @tape: a #CattleTape
- *
- * Check if the current cell is the last one of @tape.
- * 
- * Since the tape grows automatically as more cells are needed, it is
- * possible to move right from the last cell.
- *
- * Returns: %TRUE if the current cell is the last one, %FALSE otherwise
- */
-gboolean
-cattle_tape_is_at_end (CattleTape *self)
-{
-    CattleTapePrivate *priv;
-    gboolean           check;
+        g_free (bookmarks);
+        close (fd);
 
-    g_return_val_if_fail (CATTLE_IS_TAPE (self), FALSE);
+        return FALSE;
+    }
 
-    priv = self->priv;
-    g_return_val_if_fail (!priv->disposed, FALSE);
+    /* Bookmarks are relative to the origin, and must point to one of
+     * the cells stored in the file: restoring any other position would
+     * move the tape past its edges */
+    for (i = 0; i < trailer.n_bookmarks; i++)
+    {
+        if (bookmarks[i] < -trailer.origin ||
+            bookmarks[i] > (gint64) trailer.length - 1 - trailer.origin)
+        {
+            g_set_error (error,
+                         CATTLE_ERROR,
+                         CATTLE_ERROR_IO,
+                         "%s: Not a valid tape file",
+                         filename);
 
-    /* If we are in the last chunk and the current offset is equal
-     * to the upper limit, we are in the last valid position */
-    if (g_list_next (priv->current) == NULL && (priv->offset == priv->upper_limit))
+            g_free (bookmarks);
+            close (fd);
+
+            return FALSE;
+        }
+    }
+
+    cattle_tape_reset (self);
+    read_failed = FALSE;
+
+    if (priv->backend == CATTLE_TAPE_BACKEND_RESERVED &&
+        map_load (priv, fd, trailer.length))
     {
-        check = TRUE;
+        /* The first cell is at index zero */
+        priv->origin = trailer.origin;
+        priv->current = trailer.current;
+        priv->lower_limit = 0;
+        priv->upper_limit = trailer.length - 1;
+
+        success = TRUE;
     }
     else
     {
-        check = FALSE;
+        /* Read the cells a chunk at a time and store them as if the
+         * original program had written them */
+        buffer = g_malloc (SPARSE_PAGE_SIZE);
+        success = TRUE;
+        for (index = 0; success && index < trailer.length; index += count)
+        {
+            count = MIN (trailer.length - index,
+                         SPARSE_PAGE_SIZE / priv->cell_size);
+            if (!read_all (fd,
+                           buffer,
+                           count * priv->cell_size,
+                           index * priv->cell_size))
+            {
+                read_failed = TRUE;
+                success = FALSE;
+                break;
+            }
+
+            success = cattle_tape_set_range (self,
+                                             (glong) index - trailer.origin,
+                                             count,
+                                             buffer);
+        }
+        g_free (buffer);
+
+        if (success)
+        {
+            priv->current = priv->origin + (gulong) (trailer.current - trailer.origin);
+        }
     }
 
-    return check;
+    if (!success)
+    {
+        if (read_failed)
+        {
+            g_set_error (error,
+                         CATTLE_ERROR,
+                         CATTLE_ERROR_IO,
+                         "%s: %s",
+                         filename,
+                         strerror (errno));
+        }
+        else if (priv->limit_reached)
+        {
+            g_set_error (error,
+                         CATTLE_ERROR,
+                         CATTLE_ERROR_TAPE_MEMORY_LIMIT,
+                         "%s: Tape memory limit reached",
+                         filename);
+        }
+        else
+        {
+            g_set_error (error,
+                         CATTLE_ERROR,
+                         CATTLE_ERROR_TAPE_OUT_OF_BOUNDS,
+                         "%s: Tape out of bounds",
+                         filename);
+        }
+
+        g_free (bookmarks);
+        close (fd);
+        cattle_tape_reset (self);
+
+        return FALSE;
+    }
+
+    /* The file can be closed even if it has been mapped */
+    close (fd);
+
+    /* Bookmarks are relative to the origin, which has been preserved */
+    reserve_bookmarks (priv, trailer.n_bookmarks);
+    for (i = 0; i < trailer.n_bookmarks; i++)
+    {
+        priv->bookmarks[i] = bookmarks[i];
+    }
+    priv->n_bookmarks = trailer.n_bookmarks;
+    g_free (bookmarks);
+
+    update_peak_usage (priv);
+
+    return TRUE;
 }
 
 /**
@@ -534,20 +2968,22 @@ cattle_tape_is_at_end (CattleTape *self)
 void
 cattle_tape_push_bookmark (CattleTape *self)
 {
-    CattleTapePrivate  *priv;
-    CattleTapeBookmark *bookmark;
+    CattleTapePrivate *priv;
 
     g_return_if_fail (CATTLE_IS_TAPE (self));
 
     priv = self->priv;
     g_return_if_fail (!priv->disposed);
 
-    /* Create a new bookmark and store the current position */
-    bookmark = g_new0 (CattleTapeBookmark, 1);
-    bookmark->chunk = priv->current;
-    bookmark->offset = priv->offset;
+    /* Make room on the stack if needed */
+    if (G_UNLIKELY (priv->n_bookmarks == priv->max_bookmarks))
+    {
+        reserve_bookmarks (priv, priv->n_bookmarks + 1);
+    }
 
-    priv->bookmarks = g_slist_prepend (priv->bookmarks, bookmark);
+    /* Store the current position on top of the stack */
+    priv->bookmarks[priv->n_bookmarks] = (glong) (priv->current - priv->origin);
+    priv->n_bookmarks++;
 }
 
 /**
@@ -562,27 +2998,19 @@ cattle_tape_push_bookmark (CattleTape *self)
 gboolean
 cattle_tape_pop_bookmark (CattleTape *self)
 {
-    CattleTapePrivate  *priv;
-    CattleTapeBookmark *bookmark;
-    gboolean            check;
+    CattleTapePrivate *priv;
+    gboolean           check;
 
     g_return_val_if_fail (CATTLE_IS_TAPE (self), FALSE);
 
     priv = self->priv;
     g_return_val_if_fail (!priv->disposed, FALSE);
 
-    if (priv->bookmarks != NULL) {
-
-        /* Get the bookmark and remove it from the stack */
-        bookmark = priv->bookmarks->data;
-        priv->bookmarks = g_slist_remove (priv->bookmarks, bookmark);
+    if (priv->n_bookmarks > 0) {
 
-        /* Restore the position */
-        priv->current = bookmark->chunk;
-        priv->offset = bookmark->offset;
-
-        /* Delete the bookmark */
-        g_free (bookmark);
+        /* Remove the bookmark from the stack and restore the position */
+        priv->n_bookmarks--;
+        priv->current = priv->origin + (gulong) priv->bookmarks[priv->n_bookmarks];
 
         check = TRUE;
     }
@@ -594,19 +3022,102 @@ cattle_tape_pop_bookmark (CattleTape *self)
     return check;
 }
 
+gpointer
+_cattle_tape_get_current_cell_slow (CattleTape *self)
+{
+    CattleTapePrivate *priv;
+
+    priv = self->priv;
+
+    return current_cell (priv, TRUE);
+}
+
+gconstpointer
+_cattle_tape_peek_current_cell_slow (CattleTape *self)
+{
+    static const guint64  zero = 0;
+    CattleTapePrivate    *priv;
+    const guint8         *cell;
+
+    priv = self->priv;
+
+    cell = current_cell (priv, FALSE);
+
+    if (cell == NULL)
+    {
+        return &zero;
+    }
+
+    return cell;
+}
+
 static void
 cattle_tape_set_property (GObject      *object,
                           guint         property_id,
                           const GValue *value,
                           GParamSpec   *pspec)
 {
-    CattleTape *self;
-    gint8       v_int8;
+    CattleTape        *self;
+    CattleTapePrivate *priv;
+    gulong             v_ulong;
+    CattleTapeBackend  v_backend;
+    CattleCellWidth    v_width;
+    gboolean           v_boolean;
+    gint8              v_int8;
 
     self = CATTLE_TAPE (object);
+    priv = self->priv;
 
     switch (property_id)
     {
+        case PROP_SIZE:
+
+            /* A size of zero means the tape can grow */
+            v_ulong = g_value_get_ulong (value);
+            if (v_ulong > 0)
+            {
+                priv->size = v_ulong;
+                priv->fixed = TRUE;
+            }
+
+            break;
+
+        case PROP_BACKEND:
+
+            /* The backend is only used once the tape is constructed */
+            v_backend = g_value_get_enum (value);
+            priv->backend = v_backend;
+
+            break;
+
+        case PROP_CELL_WIDTH:
+
+            v_width = g_value_get_enum (value);
+            priv->width = v_width;
+
+            break;
+
+        case PROP_LEFT_GROWTH_IS_ENABLED:
+
+            v_boolean = g_value_get_boolean (value);
+            cattle_tape_set_left_growth_is_enabled (self, v_boolean);
+
+            break;
+
+        case PROP_MEMORY_LIMIT:
+
+            v_ulong = g_value_get_ulong (value);
+            cattle_tape_set_memory_limit (self, v_ulong);
+
+            break;
+
+        case PROP_HUGE_PAGES_ARE_ENABLED:
+
+            v_boolean = g_value_get_boolean (value);
+            cattle_tape_set_huge_pages_are_enabled (self, v_boolean);
+
+            break;
+
         case PROP_CURRENT_VALUE:
 
             v_int8 = g_value_get_schar (value);
@@ -630,13 +3141,59 @@ cattle_tape_get_property (GObject    *object,
                           GValue     *value,
                           GParamSpec *pspec)
 {
-    CattleTape *self;
-    gint8       v_int8;
+    CattleTape        *self;
+    gulong             v_ulong;
+    CattleTapeBackend  v_backend;
+    CattleCellWidth    v_width;
+    gboolean           v_boolean;
+    gint8              v_int8;
 
     self = CATTLE_TAPE (object);
 
     switch (property_id)
     {
+        case PROP_SIZE:
+
+            v_ulong = cattle_tape_get_size (self);
+            g_value_set_ulong (value, v_ulong);
+
+            break;
+
+        case PROP_BACKEND:
+
+            v_backend = cattle_tape_get_backend (self);
+            g_value_set_enum (value, v_backend);
+
+            break;
+
+        case PROP_CELL_WIDTH:
+
+            v_width = cattle_tape_get_cell_width (self);
+            g_value_set_enum (value, v_width);
+
+            break;
+
+        case PROP_LEFT_GROWTH_IS_ENABLED:
+
+            v_boolean = cattle_tape_get_left_growth_is_enabled (self);
+            g_value_set_boolean (value, v_boolean);
+
+            break;
+
+        case PROP_MEMORY_LIMIT:
+
+            v_ulong = cattle_tape_get_memory_limit (self);
+            g_value_set_ulong (value, v_ulong);
+
+            break;
+
+        case PROP_HUGE_PAGES_ARE_ENABLED:
+
+            v_boolean = cattle_tape_get_huge_pages_are_enabled (self);
+            g_value_set_boolean (value, v_boolean);
+
+            break;
+
         case PROP_CURRENT_VALUE:
 
             v_int8 = cattle_tape_get_current_value (self);
@@ -664,9 +3221,102 @@ cattle_tape_class_init (CattleTapeClass *self)
 
     object_class->set_property = cattle_tape_set_property;
     object_class->get_property = cattle_tape_get_property;
+    object_class->constructed = cattle_tape_constructed;
     object_class->dispose = cattle_tape_dispose;
     object_class->finalize = cattle_tape_finalize;
 
+    /**
+     * CattleTape:size:
+     *
+     * Number of cells in a tape with a fixed size, or zero for a tape
+     * that grows automatically as more cells are needed.
+     */
+    pspec = g_param_spec_ulong ("size",
+                                "Number of cells",
+                                "Get number of cells in a fixed-size tape",
+                                0,
+                                G_MAXULONG,
+                                0,
+                                G_PARAM_READWRITE|G_PARAM_CONSTRUCT_ONLY);
+    g_object_class_install_property (object_class,
+                                     PROP_SIZE,
+                                     pspec);
+
+    /**
+     * CattleTape:backend:
+     *
+     * Backend used to allocate the cells of the tape.
+     */
+    pspec = g_param_spec_enum ("backend",
+                               "Memory backend",
+                               "Get memory backend",
+                               CATTLE_TYPE_TAPE_BACKEND,
+                               CATTLE_TAPE_BACKEND_HEAP,
+                               G_PARAM_READWRITE|G_PARAM_CONSTRUCT_ONLY);
+    g_object_class_install_property (object_class,
+                                     PROP_BACKEND,
+                                     pspec);
+
+    /**
+     * CattleTape:cell-width:
+     *
+     * Width of the cells in the tape.
+     */
+    pspec = g_param_spec_enum ("cell-width",
+                               "Width of the cells",
+                               "Get width of the cells",
+                               CATTLE_TYPE_CELL_WIDTH,
+                               CATTLE_CELL_WIDTH_8,
+                               G_PARAM_READWRITE|G_PARAM_CONSTRUCT_ONLY);
+    g_object_class_install_property (object_class,
+                                     PROP_CELL_WIDTH,
+                                     pspec);
+
+    /**
+     * CattleTape:left-growth-is-enabled:
+     *
+     * Whether the tape is allowed to grow on the left.
+     */
+    pspec = g_param_spec_boolean ("left-growth-is-enabled",
+                                  "Whether the tape can grow on the left",
+                                  "Get/set left growth status",
+                                  TRUE,
+                                  G_PARAM_READWRITE);
+    g_object_class_install_property (object_class,
+                                     PROP_LEFT_GROWTH_IS_ENABLED,
+                                     pspec);
+
+    /**
+     * CattleTape:memory-limit:
+     *
+     * Maximum number of bytes the tape can use for its cells, or zero
+     * if there is no limit.
+     */
+    pspec = g_param_spec_ulong ("memory-limit",
+                                "Maximum memory usage",
+                                "Get/set memory limit",
+                                0,
+                                G_MAXULONG,
+                                0,
+                                G_PARAM_READWRITE);
+    g_object_class_install_property (object_class,
+                                     PROP_MEMORY_LIMIT,
+                                     pspec);
+
+    /**
+     * CattleTape:huge-pages-are-enabled:
+     *
+     * Whether the memory used by the tape is backed by huge pages.
+     */
+    pspec = g_param_spec_boolean ("huge-pages-are-enabled",
+                                  "Whether the tape uses huge pages",
+                                  "Get/set huge pages status",
+                                  FALSE,
+                                  G_PARAM_READWRITE);
+    g_object_class_install_property (object_class,
+                                     PROP_HUGE_PAGES_ARE_ENABLED,
+                                     pspec);
+
     /**
      * CattleTape:current-value:
      *
@@ -36,6 +36,21 @@ G_BEGIN_DECLS
 #define CATTLE_IS_TAPE_CLASS(klass)   (G_TYPE_CHECK_CLASS_TYPE ((klass), CATTLE_TYPE_TAPE))
 #define CATTLE_TAPE_GET_CLASS(object) (G_TYPE_INSTANCE_GET_CLASS ((object), CATTLE_TYPE_TAPE, CattleTapeClass))
 
+typedef enum
+{
+    CATTLE_TAPE_BACKEND_HEAP,
+    CATTLE_TAPE_BACKEND_RESERVED,
+    CATTLE_TAPE_BACKEND_SPARSE
+} CattleTapeBackend;
+
+typedef enum
+{
+    CATTLE_CELL_WIDTH_8 = 8,
+    CATTLE_CELL_WIDTH_16 = 16,
+    CATTLE_CELL_WIDTH_32 = 32,
+    CATTLE_CELL_WIDTH_64 = 64
+} CattleCellWidth;
+
 typedef struct _CattleTape        CattleTape;
 typedef struct _CattleTapeClass   CattleTapeClass;
 typedef struct _CattleTapePrivate CattleTapePrivate;
@@ -51,28 +66,70 @@ struct _CattleTapeClass
     GObjectClass parent;
 };
 
-CattleTape* cattle_tape_new                       (void);
-void        cattle_tape_set_current_value         (CattleTape *tape,
-                                                   gint8       value);
-gint8       cattle_tape_get_current_value         (CattleTape *tape);
-void        cattle_tape_increase_current_value    (CattleTape *tape);
-void        cattle_tape_increase_current_value_by (CattleTape *tape,
-                                                   gulong      value);
-void        cattle_tape_decrease_current_value    (CattleTape *tape);
-void        cattle_tape_decrease_current_value_by (CattleTape *tape,
-                                                   gulong      value);
-void        cattle_tape_move_left                 (CattleTape *tape);
-void        cattle_tape_move_left_by              (CattleTape *tape,
-                                                   gulong      steps);
-void        cattle_tape_move_right                (CattleTape *tape);
-void        cattle_tape_move_right_by             (CattleTape *tape,
-                                                   gulong      steps);
-gboolean    cattle_tape_is_at_beginning           (CattleTape *tape);
-gboolean    cattle_tape_is_at_end                 (CattleTape *tape);
-void        cattle_tape_push_bookmark             (CattleTape *tape);
-gboolean    cattle_tape_pop_bookmark              (CattleTape *tape);
+CattleTape*       cattle_tape_new                        (void);
+CattleTape*       cattle_tape_new_with_size              (gulong              size);
+CattleTape*       cattle_tape_new_with_backend           (CattleTapeBackend   backend);
+CattleTape*       cattle_tape_new_with_cell_width        (CattleCellWidth     width);
+CattleTape*       cattle_tape_snapshot                   (CattleTape         *tape);
+void              cattle_tape_reset                      (CattleTape         *tape);
+gulong            cattle_tape_get_size                   (CattleTape         *tape);
+CattleTapeBackend cattle_tape_get_backend                (CattleTape         *tape);
+CattleCellWidth   cattle_tape_get_cell_width             (CattleTape         *tape);
+void              cattle_tape_set_left_growth_is_enabled (CattleTape         *tape,
+                                                          gboolean            enabled);
+gboolean          cattle_tape_get_left_growth_is_enabled (CattleTape         *tape);
+void              cattle_tape_set_huge_pages_are_enabled (CattleTape         *tape,
+                                                          gboolean            enabled);
+gboolean          cattle_tape_get_huge_pages_are_enabled (CattleTape         *tape);
+void              cattle_tape_set_memory_limit           (CattleTape         *tape,
+                                                          gulong              limit);
+gulong            cattle_tape_get_memory_limit           (CattleTape         *tape);
+gulong            cattle_tape_get_memory_usage           (CattleTape         *tape);
+gulong            cattle_tape_get_peak_memory_usage      (CattleTape         *tape);
+void              cattle_tape_set_current_value          (CattleTape         *tape,
+                                                          gint8               value);
+gint8             cattle_tape_get_current_value          (CattleTape         *tape);
+void              cattle_tape_set_current_wide_value     (CattleTape         *tape,
+                                                          gint64              value);
+gint64            cattle_tape_get_current_wide_value     (CattleTape         *tape);
+void              cattle_tape_increase_current_value     (CattleTape         *tape);
+void              cattle_tape_increase_current_value_by  (CattleTape         *tape,
+                                                          gulong              value);
+void              cattle_tape_decrease_current_value     (CattleTape         *tape);
+void              cattle_tape_decrease_current_value_by  (CattleTape         *tape,
+                                                          gulong              value);
+gboolean          cattle_tape_move_left                  (CattleTape         *tape);
+gboolean          cattle_tape_move_left_by               (CattleTape         *tape,
+                                                          gulong              steps);
+gboolean          cattle_tape_move_right                 (CattleTape         *tape);
+gboolean          cattle_tape_move_right_by              (CattleTape         *tape,
+                                                          gulong              steps);
+void              cattle_tape_reserve                    (CattleTape         *tape,
+                                                          gulong              before,
+                                                          gulong              after);
+gboolean          cattle_tape_is_at_beginning            (CattleTape         *tape);
+gboolean          cattle_tape_is_at_end                  (CattleTape         *tape);
+void              cattle_tape_get_range                  (CattleTape         *tape,
+                                                          glong               offset,
+                                                          gulong              length,
+                                                          gpointer            data);
+gboolean          cattle_tape_set_range                  (CattleTape         *tape,
+                                                          glong               offset,
+                                                          gulong              length,
+                                                          gconstpointer       data);
+gconstpointer     cattle_tape_peek_range                 (CattleTape         *tape,
+                                                          glong               offset,
+                                                          gulong              length);
+gboolean          cattle_tape_save                       (CattleTape         *tape,
+                                                          const gchar        *filename,
+                                                          GError            **error);
+gboolean          cattle_tape_load                       (CattleTape         *tape,
+                                                          const gchar        *filename,
+                                                          GError            **error);
+void              cattle_tape_push_bookmark              (CattleTape         *tape);
+gboolean          cattle_tape_pop_bookmark               (CattleTape         *tape);
 
-GType       cattle_tape_get_type                  (void) G_GNUC_CONST;
+GType             cattle_tape_get_type                   (void) G_GNUC_CONST;
 
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (CattleTape, g_object_unref)
 
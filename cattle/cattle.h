@@ -26,6 +26,7 @@
 #include <cattle/cattle-constants.h>
 #include <cattle/cattle-error.h>
 #include <cattle/cattle-buffer.h>
+#include <cattle/cattle-buffer-pool.h>
 #include <cattle/cattle-tape.h>
 #include <cattle/cattle-instruction.h>
 #include <cattle/cattle-program.h>
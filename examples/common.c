@@ -21,21 +21,16 @@
 #include <gio/gio.h>
 #include "common.h"
 
-CattleBuffer*
-read_file_contents (const gchar  *path,
+static CattleBuffer*
+load_file_contents (const gchar  *path,
                     GError      **error)
 {
-    CattleBuffer      *buffer;
     g_autoptr (GFile)  file = NULL;
-    g_autofree gchar  *contents = NULL;
+    gchar             *contents;
     GError            *inner_error;
-    gint8             *start;
     gsize              length;
     gboolean           success;
 
-    g_return_val_if_fail (path != NULL, NULL);
-    g_return_val_if_fail (error == NULL || *error == NULL, NULL);
-
     file = g_file_new_for_commandline_arg (path);
 
     inner_error = NULL;
@@ -54,24 +49,56 @@ read_file_contents (const gchar  *path,
         return NULL;
     }
 
-    start = (gint8 *) contents;
+    /* The buffer takes ownership of the contents instead of
+     * copying them */
+    return cattle_buffer_new_with_free_func (contents,
+                                             length,
+                                             g_free,
+                                             contents);
+}
 
-    /* Skip the sha-bang line if present */
-    if (length >= 2 && contents[0] == '#' && contents[1] == '!')
+CattleBuffer*
+read_file_contents (const gchar  *path,
+                    GError      **error)
+{
+    g_autoptr (CattleBuffer) buffer = NULL;
+    gulong                   size;
+    gulong                   start;
+
+    g_return_val_if_fail (path != NULL, NULL);
+    g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+    /* Map the file instead of reading it, so that large programs
+     * are loaded from disk only as they're parsed */
+    buffer = cattle_buffer_new_from_file (path, NULL);
+
+    /* Only regular local files can be mapped: URIs, pipes and
+     * process substitutions are read in full instead */
+    if (buffer == NULL)
     {
-        while (length > 0 && start[0] != '\n')
-        {
-            start++;
-            length--;
-        }
+        buffer = load_file_contents (path, error);
     }
 
-    buffer = cattle_buffer_new (length);
+    if (buffer == NULL)
+    {
+        return NULL;
+    }
+
+    size = cattle_buffer_get_size (buffer);
+    start = 0;
 
-    if (length > 0)
+    /* Skip the sha-bang line if present */
+    if (size >= 2 &&
+        cattle_buffer_get_value (buffer, 0) == '#' &&
+        cattle_buffer_get_value (buffer, 1) == '!')
     {
-        cattle_buffer_set_contents (buffer, start);
+        while (start < size && cattle_buffer_get_value (buffer, start) != '\n')
+        {
+            start++;
+        }
     }
 
-    return buffer;
+    /* The rest of the file is returned as a slice, so it's
+     * not copied */
+    return cattle_buffer_new_slice (buffer, start, size - start);
 }
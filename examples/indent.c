@@ -21,6 +21,7 @@
 #include <glib.h>
 #include <glib-object.h>
 #include <cattle/cattle.h>
+#include <stdio.h>
 #include "common.h"
 
 static void
@@ -34,6 +35,8 @@ indent (CattleProgram *program)
     g_autoptr (GSList)        stack = NULL;
     gulong                    level;
     gulong                    quantity;
+    gint8                     chunk[4096];
+    gulong                    length;
     gulong                    size;
     gulong                    i;
 
@@ -124,11 +127,12 @@ indent (CattleProgram *program)
     {
         g_print ("!");
 
-        for (i = 0; i < size; i++)
+        for (i = 0; i < size; i += length)
         {
-            value = cattle_buffer_get_value (input, i);
+            length = MIN (size - i, sizeof (chunk));
+            cattle_buffer_get_contents_at (input, i, chunk, length);
 
-            g_print ("%c", value);
+            fwrite (chunk, 1, length, stdout);
         }
     }
 }
@@ -21,6 +21,7 @@
 #include <glib.h>
 #include <glib-object.h>
 #include <cattle/cattle.h>
+#include <stdio.h>
 #include "common.h"
 
 #define WIDTH 75 /* Line lenght */
@@ -36,6 +37,8 @@ minimize (CattleProgram *program)
     gchar                     value;
     gulong                    quantity;
     gulong                    position;
+    gint8                     chunk[4096];
+    gulong                    length;
     gulong                    size;
     gulong                    i;
 
@@ -114,11 +117,12 @@ minimize (CattleProgram *program)
     {
         g_print ("!");
 
-        for (i = 0; i < size; i++)
+        for (i = 0; i < size; i += length)
         {
-            value = cattle_buffer_get_value (input, i);
+            length = MIN (size - i, sizeof (chunk));
+            cattle_buffer_get_contents_at (input, i, chunk, length);
 
-            g_print ("%c", value);
+            fwrite (chunk, 1, length, stdout);
         }
     }
 }
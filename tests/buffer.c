@@ -20,7 +20,9 @@
 
 #include <glib.h>
 #include <glib-object.h>
+#include <glib/gstdio.h>
 #include <cattle/cattle.h>
+#include <string.h>
 
 /**
  * test_buffer_empty:
@@ -145,6 +147,348 @@ test_buffer_set_value (void)
     }
 }
 
+/**
+ * test_buffer_wrap:
+ *
+ * Ensure a buffer can wrap existing memory without copying it, and
+ * that the memory is released when no longer needed.
+ */
+static void
+test_buffer_wrap (void)
+{
+    g_autoptr (CattleBuffer) buffer = NULL;
+    gint8                   *data;
+    gint                     i;
+
+    data = (gint8 *) g_strdup ("abc");
+
+    buffer = cattle_buffer_new_with_free_func (data, 3, g_free, data);
+    g_assert (cattle_buffer_get_size (buffer) == 3);
+
+    for (i = 0; i < 3; i++)
+    {
+        g_assert (cattle_buffer_get_value (buffer, i) == 'a' + i);
+    }
+
+    /* Changes to the memory are visible through the buffer */
+    data[1] = 'x';
+    g_assert (cattle_buffer_get_value (buffer, 1) == 'x');
+
+    g_clear_object (&buffer);
+
+    /* Memory with static lifetime needs no free function */
+    buffer = cattle_buffer_new_with_free_func ("", 0, NULL, NULL);
+    g_assert (cattle_buffer_get_size (buffer) == 0);
+}
+
+/**
+ * test_buffer_bytes:
+ *
+ * Ensure a buffer can wrap a #GBytes, and that modifying the buffer
+ * doesn't modify the #GBytes.
+ */
+static void
+test_buffer_bytes (void)
+{
+    g_autoptr (CattleBuffer) buffer = NULL;
+    GBytes                  *bytes;
+    const gchar             *data;
+
+    bytes = g_bytes_new ("+-<>", 4);
+    buffer = cattle_buffer_new_from_bytes (bytes);
+    g_bytes_unref (bytes);
+
+    g_assert (cattle_buffer_get_size (buffer) == 4);
+    g_assert (cattle_buffer_get_value (buffer, 0) == '+');
+    g_assert (cattle_buffer_get_value (buffer, 3) == '>');
+
+    bytes = g_bytes_new_static ("[-]", 3);
+    g_clear_object (&buffer);
+    buffer = cattle_buffer_new_from_bytes (bytes);
+
+    cattle_buffer_set_value (buffer, 1, '+');
+    g_assert (cattle_buffer_get_value (buffer, 0) == '[');
+    g_assert (cattle_buffer_get_value (buffer, 1) == '+');
+    g_assert (cattle_buffer_get_value (buffer, 2) == ']');
+
+    data = g_bytes_get_data (bytes, NULL);
+    g_assert (data[1] == '-');
+
+    g_bytes_unref (bytes);
+}
+
+/**
+ * test_buffer_file:
+ *
+ * Ensure a buffer can be created from the contents of a file, and
+ * that modifying the buffer doesn't modify the file.
+ */
+static void
+test_buffer_file (void)
+{
+    g_autoptr (CattleBuffer) buffer = NULL;
+    g_autoptr (GError)       error = NULL;
+    g_autofree gchar        *contents = NULL;
+    gchar                   *filename;
+    gint                     fd;
+
+    fd = g_file_open_tmp ("cattle-buffer-XXXXXX", &filename, NULL);
+    g_assert (fd >= 0);
+    g_close (fd, NULL);
+
+    g_assert (g_file_set_contents (filename, "+[>+]", -1, NULL));
+
+    buffer = cattle_buffer_new_from_file (filename, &error);
+    g_assert_no_error (error);
+    g_assert (cattle_buffer_get_size (buffer) == 5);
+    g_assert (cattle_buffer_get_value (buffer, 1) == '[');
+    g_assert (cattle_buffer_get_value (buffer, 4) == ']');
+
+    cattle_buffer_set_value (buffer, 0, '-');
+    g_assert (cattle_buffer_get_value (buffer, 0) == '-');
+
+    g_assert (g_file_get_contents (filename, &contents, NULL, NULL));
+    g_assert_cmpstr (contents, ==, "+[>+]");
+
+    g_unlink (filename);
+    g_free (filename);
+
+    /* Files that can't be opened are reported */
+    g_clear_object (&buffer);
+    buffer = cattle_buffer_new_from_file ("/nonexistent/cattle", &error);
+    g_assert (buffer == NULL);
+    g_assert_error (error, CATTLE_ERROR, CATTLE_ERROR_IO);
+}
+
+/**
+ * test_buffer_contents_at:
+ *
+ * Ensure ranges of bytes can be copied in and out of a memory buffer.
+ */
+static void
+test_buffer_contents_at (void)
+{
+    g_autoptr (CattleBuffer) buffer = NULL;
+    gint8                    values[4];
+    gint                     i;
+
+    buffer = cattle_buffer_new (6);
+
+    cattle_buffer_set_contents_at (buffer, 2, (gint8 *) "abc", 3);
+    g_assert (cattle_buffer_get_value (buffer, 1) == 0);
+    g_assert (cattle_buffer_get_value (buffer, 2) == 'a');
+    g_assert (cattle_buffer_get_value (buffer, 4) == 'c');
+    g_assert (cattle_buffer_get_value (buffer, 5) == 0);
+
+    cattle_buffer_get_contents_at (buffer, 1, values, 4);
+    g_assert (values[0] == 0);
+    g_assert (values[1] == 'a');
+    g_assert (values[2] == 'b');
+    g_assert (values[3] == 'c');
+
+    /* Empty ranges are allowed, even at the very end */
+    cattle_buffer_set_contents_at (buffer, 6, NULL, 0);
+    cattle_buffer_get_contents_at (buffer, 6, NULL, 0);
+
+    /* Wrapped memory is copied before being modified */
+    g_clear_object (&buffer);
+    buffer = cattle_buffer_new_with_free_func ("wxyz", 4, NULL, NULL);
+    cattle_buffer_set_contents_at (buffer, 3, (gint8 *) "!", 1);
+    cattle_buffer_get_contents_at (buffer, 0, values, 4);
+
+    for (i = 0; i < 4; i++)
+    {
+        g_assert (values[i] == "wxy!"[i]);
+    }
+}
+
+/**
+ * test_buffer_slice:
+ *
+ * Ensure a slice shows the contents of its parent, keeps it alive, and
+ * can be modified without affecting it.
+ */
+static void
+test_buffer_slice (void)
+{
+    g_autoptr (CattleBuffer) buffer = NULL;
+    g_autoptr (CattleBuffer) slice = NULL;
+    g_autoptr (CattleBuffer) nested = NULL;
+    GBytes                  *bytes;
+
+    bytes = g_bytes_new ("+[-]>!input", 11);
+    buffer = cattle_buffer_new_from_bytes (bytes);
+    g_bytes_unref (bytes);
+
+    slice = cattle_buffer_new_slice (buffer, 6, 5);
+    g_assert (cattle_buffer_get_size (slice) == 5);
+    g_assert (cattle_buffer_get_value (slice, 0) == 'i');
+    g_assert (cattle_buffer_get_value (slice, 4) == 't');
+
+    nested = cattle_buffer_new_slice (slice, 2, 2);
+    g_assert (cattle_buffer_get_size (nested) == 2);
+    g_assert (cattle_buffer_get_value (nested, 0) == 'p');
+    g_assert (cattle_buffer_get_value (nested, 1) == 'u');
+
+    /* Slices keep the memory they refer to alive, even when the
+     * parent makes its own copy to be modified */
+    cattle_buffer_set_value (buffer, 7, 'N');
+    g_clear_object (&buffer);
+    g_assert (cattle_buffer_get_value (slice, 1) == 'n');
+
+    /* Modifying a slice doesn't modify its parent */
+    cattle_buffer_set_value (slice, 2, 'P');
+    g_assert (cattle_buffer_get_value (slice, 2) == 'P');
+    g_assert (cattle_buffer_get_value (nested, 0) == 'p');
+
+    /* Empty slices are allowed, even at the very end */
+    g_clear_object (&nested);
+    nested = cattle_buffer_new_slice (slice, 5, 0);
+    g_assert (cattle_buffer_get_size (nested) == 0);
+}
+
+/**
+ * test_buffer_growable:
+ *
+ * Ensure data can be appended to a growable buffer, and that clearing
+ * it makes it possible to reuse it.
+ */
+static void
+test_buffer_growable (void)
+{
+    g_autoptr (CattleBuffer) buffer = NULL;
+    gint8                    values[1000];
+    gint                     i;
+
+    buffer = cattle_buffer_new_with_mode (CATTLE_BUFFER_MODE_GROWABLE, 2);
+    g_assert (cattle_buffer_get_mode (buffer) == CATTLE_BUFFER_MODE_GROWABLE);
+    g_assert (cattle_buffer_get_size (buffer) == 2);
+
+    cattle_buffer_set_value (buffer, 1, 'a');
+    cattle_buffer_append (buffer, (gint8 *) "bc", 2);
+    g_assert (cattle_buffer_get_size (buffer) == 4);
+    g_assert (cattle_buffer_get_value (buffer, 0) == 0);
+    g_assert (cattle_buffer_get_value (buffer, 1) == 'a');
+    g_assert (cattle_buffer_get_value (buffer, 3) == 'c');
+
+    /* Append enough data to force the buffer to grow a few times */
+    for (i = 0; i < 1000; i++)
+    {
+        values[i] = (gint8) i;
+    }
+    for (i = 0; i < 10; i++)
+    {
+        cattle_buffer_append (buffer, values, 1000);
+    }
+    g_assert (cattle_buffer_get_size (buffer) == 10004);
+    g_assert (cattle_buffer_get_value (buffer, 3) == 'c');
+    g_assert (cattle_buffer_get_value (buffer, 10003) == (gint8) 999);
+
+    cattle_buffer_clear (buffer);
+    g_assert (cattle_buffer_get_size (buffer) == 0);
+
+    cattle_buffer_append (buffer, (gint8 *) "d", 1);
+    g_assert (cattle_buffer_get_size (buffer) == 1);
+    g_assert (cattle_buffer_get_value (buffer, 0) == 'd');
+}
+
+/**
+ * test_buffer_ring:
+ *
+ * Ensure data written to a ring buffer is read back in the same order,
+ * including when the cursors wrap around.
+ */
+static void
+test_buffer_ring (void)
+{
+    g_autoptr (CattleBuffer) buffer = NULL;
+    gint8                    values[8];
+
+    buffer = cattle_buffer_new_with_mode (CATTLE_BUFFER_MODE_RING, 5);
+    g_assert (cattle_buffer_get_mode (buffer) == CATTLE_BUFFER_MODE_RING);
+    g_assert (cattle_buffer_get_size (buffer) == 5);
+    g_assert (cattle_buffer_get_available (buffer) == 0);
+    g_assert (cattle_buffer_read (buffer, values, 8) == 0);
+
+    g_assert (cattle_buffer_write (buffer, (gint8 *) "abc", 3) == 3);
+    g_assert (cattle_buffer_read (buffer, values, 2) == 2);
+    g_assert (values[0] == 'a');
+    g_assert (values[1] == 'b');
+
+    /* Only as much data as there's room for can be written */
+    g_assert (cattle_buffer_write (buffer, (gint8 *) "defghi", 6) == 4);
+    g_assert (cattle_buffer_get_available (buffer) == 5);
+    g_assert (cattle_buffer_write (buffer, (gint8 *) "x", 1) == 0);
+
+    g_assert (cattle_buffer_read (buffer, values, 8) == 5);
+    g_assert (memcmp (values, "cdefg", 5) == 0);
+    g_assert (cattle_buffer_get_available (buffer) == 0);
+
+    /* Unread data is discarded when the buffer is cleared */
+    g_assert (cattle_buffer_write (buffer, (gint8 *) "jk", 2) == 2);
+    cattle_buffer_clear (buffer);
+    g_assert (cattle_buffer_get_available (buffer) == 0);
+    g_assert (cattle_buffer_write (buffer, (gint8 *) "lmnop", 5) == 5);
+    g_assert (cattle_buffer_read (buffer, values, 8) == 5);
+    g_assert (memcmp (values, "lmnop", 5) == 0);
+}
+
+/**
+ * test_buffer_pool:
+ *
+ * Check buffers are recycled by a pool once they're no longer in use.
+ */
+static void
+test_buffer_pool (void)
+{
+    g_autoptr (CattleBufferPool) pool = NULL;
+    CattleBuffer                *first;
+    CattleBuffer                *second;
+    CattleBuffer                *buffer;
+    CattleBuffer                *extra;
+
+    pool = cattle_buffer_pool_new ();
+    cattle_buffer_pool_set_max_buffers (pool, 2);
+    g_assert (cattle_buffer_pool_get_max_buffers (pool) == 2);
+
+    first = cattle_buffer_pool_acquire (pool, 16);
+    g_assert (cattle_buffer_get_mode (first) == CATTLE_BUFFER_MODE_GROWABLE);
+    g_assert (cattle_buffer_get_size (first) == 0);
+    cattle_buffer_append (first, (gint8 *) "abc", 3);
+
+    /* A buffer that's still in use is never handed out again */
+    second = cattle_buffer_pool_acquire (pool, 16);
+    g_assert (second != first);
+
+    /* References taken by someone else keep a buffer in use after
+     * the one obtained from the pool has been released */
+    extra = g_object_ref (first);
+    g_object_unref (first);
+    buffer = cattle_buffer_pool_acquire (pool, 16);
+    g_assert (buffer != first);
+    g_assert (buffer != second);
+    g_object_unref (buffer);
+    g_object_unref (extra);
+
+    /* Released buffers are recycled, and come back empty */
+    buffer = cattle_buffer_pool_acquire (pool, 16);
+    g_assert (buffer == first);
+    g_assert (cattle_buffer_get_size (buffer) == 0);
+
+    /* When the pool is full, buffers are not kept around */
+    first = cattle_buffer_pool_acquire (pool, 16);
+    g_assert (first != buffer);
+    g_assert (first != second);
+    g_object_unref (first);
+    first = cattle_buffer_pool_acquire (pool, 16);
+    g_assert (first != buffer);
+    g_assert (first != second);
+
+    g_object_unref (first);
+    g_object_unref (second);
+    g_object_unref (buffer);
+}
+
 gint
 main (gint argc, gchar **argv)
 {
@@ -162,6 +506,22 @@ main (gint argc, gchar **argv)
                      test_buffer_set_contents_string);
     g_test_add_func ("/buffer/set-value",
                      test_buffer_set_value);
+    g_test_add_func ("/buffer/contents-at",
+                     test_buffer_contents_at);
+    g_test_add_func ("/buffer/wrap",
+                     test_buffer_wrap);
+    g_test_add_func ("/buffer/bytes",
+                     test_buffer_bytes);
+    g_test_add_func ("/buffer/file",
+                     test_buffer_file);
+    g_test_add_func ("/buffer/slice",
+                     test_buffer_slice);
+    g_test_add_func ("/buffer/growable",
+                     test_buffer_growable);
+    g_test_add_func ("/buffer/ring",
+                     test_buffer_ring);
+    g_test_add_func ("/buffer/pool",
+                     test_buffer_pool);
 
     return g_test_run ();
 }
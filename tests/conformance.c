@@ -0,0 +1,745 @@
+/* conformance - Differential tests for the interpreter implementation
+ * Copyright (C) 2008-2020  Andrea Bolognani <eof@kiyuko.org>
+ * This file is part of Cattle
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Homepage: https://kiyuko.org/software/cattle
+ */
+
+#include <glib.h>
+#include <glib-object.h>
+#include <cattle/cattle.h>
+#include <string.h>
+
+/* Every program is run both by Cattle and by the small reference
+ * evaluator below, under every possible configuration, and the results
+ * are compared: output, including tape dumps produced by debugging
+ * instructions, final tape contents, final pointer position and
+ * reported errors must all match */
+
+#define REFERENCE_TAPE_SIZE 65536
+
+/* Number of steps after which programs are assumed to be running
+ * forever by the reference evaluator */
+#define CORPUS_MAX_STEPS    1000000
+#define BENCHMARK_MAX_STEPS 1000000000
+
+/* Size of the chunks runtime input is fed to the interpreter in */
+#define INPUT_CHUNK_SIZE 3
+
+typedef struct
+{
+    const gchar *code;
+    const gchar *input;          /* Runtime input */
+    gboolean     cycles_only;    /* Only terminates with cycle detection */
+} Program;
+
+typedef struct
+{
+    CattleEndOfInputAction end_of_input_action;
+    gboolean               debug_is_enabled;
+    gboolean               cycle_detection_is_enabled;
+    gboolean               bulk_output;
+    CattleTapeBackend      backend;
+} Configuration;
+
+typedef struct
+{
+    gboolean  success;
+    gint      code;              /* Error code, if not successful */
+    GString  *output;
+    GString  *tape;              /* Dump of the final tape */
+    gdouble   elapsed;
+} Outcome;
+
+typedef struct
+{
+    const gchar *input;
+    gulong       offset;
+} InputState;
+
+static const Program corpus[] = {
+    /* Plain programs */
+    { "++++++++[>++++[>++>+++>+++>+<<<<-]>+>+>->>+[<]<-]>>.>---.+++++++..+++.>>.<-.<.+++.------.--------.>>+.>++.", NULL, FALSE },
+    { "++++++++[>++++++++<-]>+.+.+.", NULL, FALSE },
+    { "+++++[>+++<-]>[>++<-]>.", NULL, FALSE },
+    { "<<<+++[>+++<-]>.<<.", NULL, FALSE },
+    { "-.+.--.", NULL, FALSE },
+    { "--[-->+<]>.", NULL, FALSE },
+    { "+>++>+++>++++<<<-->>>>>>>>><<<<<<+", NULL, FALSE },
+    { "This is a comment +++ with ++ some -- commands . in it", NULL, FALSE },
+    { "", NULL, FALSE },
+
+    /* Tape growing in both directions */
+    { "-[[>+<-]>-]", NULL, FALSE },
+    { "-[[<+>-]<-]", NULL, FALSE },
+    { "-[[>+<-]>-]-[[<+>-]<-]<<<<+.", NULL, FALSE },
+    { "+[>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>[-]<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<-]", NULL, FALSE },
+
+    /* Loops the loader classifies */
+    { "+[[-]>+<]>.", NULL, FALSE },
+    { "+++[>+++[>++<-]<[-]]>>.", NULL, FALSE },
+    { "[>++++++++[>++++++++<-]<[-]]>>+.", NULL, FALSE },
+    { "++[>+[>+<[-]]<[-]]>>+++++++[<++++++++>-]<+.", NULL, FALSE },
+    { "+[>+<-]>[<+>-]<[-]+[>+<[-]]>.", NULL, FALSE },
+    { "++++[>+>++<<-]>[>[-]<-]>.", NULL, FALSE },
+
+    /* Input */
+    { ",.>,.>,.>,.>,.>,.", "Cat", FALSE },
+    { ",.>,.>,.>,.>,.>,.", "Cattle!", FALSE },
+    { ",>,>,>,[<]>[.>]", "Hi", FALSE },
+    { ",.>,.>,.>,.!ab", "ignored", FALSE },
+    { ",.,.,.!", "xyz", FALSE },
+    { "+++>,<[>.<-]", "", FALSE },
+
+    /* Debugging */
+    { "+>++<#>#", NULL, FALSE },
+    { "<<+#>>>-##", NULL, FALSE },
+
+    /* Errors */
+    { "[[]", NULL, FALSE },
+    { "+]", NULL, FALSE },
+    { "+[]", NULL, FALSE },
+    { "+.[>+<]", NULL, FALSE },
+    { "+[+[-]+]", NULL, TRUE },
+    { "+[>+<+[-]+]", NULL, TRUE },
+    { "-[-->+<]", NULL, TRUE },
+};
+
+static const Program benchmarks[] = {
+    { "-[>-[>-[-]<-]<-]", NULL, FALSE },
+    { "-[>+>+<<-]>[>[>+<-]<-]", NULL, FALSE },
+    { "++++++++[>++++<-]>>-[<<.....>>-]", NULL, FALSE },
+    { "-[[>+<-]>-]-[[<+>-]<-]", NULL, FALSE },
+};
+
+/* Append a human-readable version of the tape to @dump */
+static void
+format_tape (GString     *dump,
+             const gint8 *cells,
+             gulong       size,
+             gulong       position)
+{
+    gulong i;
+
+    g_string_append_c (dump, '[');
+
+    for (i = 0; i < size; i++)
+    {
+        g_string_append_printf (dump,
+                                i == position ? "%s<%d>" : "%s%d",
+                                i == 0 ? "" : " ",
+                                cells[i]);
+    }
+
+    g_string_append_c (dump, ']');
+}
+
+/* Append the contents of @tape, from the leftmost cell to the
+ * rightmost one, to @dump */
+static void
+dump_tape (CattleTape *tape,
+           GString    *dump)
+{
+    g_autoptr (GString) cells = NULL;
+    gulong              position;
+
+    cells = g_string_new (NULL);
+
+    /* Save the current position so it can be restored later */
+    cattle_tape_push_bookmark (tape);
+
+    position = 0;
+    while (!cattle_tape_is_at_beginning (tape))
+    {
+        cattle_tape_move_left (tape);
+        position++;
+    }
+
+    while (TRUE)
+    {
+        g_string_append_c (cells,
+                           (gchar) cattle_tape_get_current_value (tape));
+
+        if (cattle_tape_is_at_end (tape))
+        {
+            break;
+        }
+
+        cattle_tape_move_right (tape);
+    }
+
+    cattle_tape_pop_bookmark (tape);
+
+    format_tape (dump,
+                 (gint8 *) cells->str,
+                 cells->len,
+                 position);
+}
+
+/* Input handler feeding the interpreter a few bytes at a time */
+static gboolean
+input_chunks (CattleInterpreter  *interpreter,
+              gpointer            data,
+              GError            **error G_GNUC_UNUSED)
+{
+    g_autoptr (CattleBuffer) input = NULL;
+    InputState              *state;
+    gulong                   size;
+
+    state = (InputState *) data;
+
+    size = MIN (strlen (state->input + state->offset), INPUT_CHUNK_SIZE);
+
+    /* Not feeding the interpreter means the input is over */
+    if (size > 0)
+    {
+        input = cattle_buffer_new (size);
+        cattle_buffer_set_contents (input,
+                                    (gint8 *) state->input + state->offset);
+
+        cattle_interpreter_feed (interpreter, input);
+
+        state->offset += size;
+    }
+
+    return TRUE;
+}
+
+static gboolean
+output_single (CattleInterpreter  *interpreter G_GNUC_UNUSED,
+               gint8               output,
+               gpointer            data,
+               GError            **error G_GNUC_UNUSED)
+{
+    g_string_append_c ((GString *) data,
+                       (gchar) output);
+
+    return TRUE;
+}
+
+static gboolean
+output_bulk (CattleInterpreter  *interpreter G_GNUC_UNUSED,
+             gint8               output,
+             gulong              count,
+             gpointer            data,
+             GError            **error G_GNUC_UNUSED)
+{
+    gulong i;
+
+    for (i = 0; i < count; i++)
+    {
+        g_string_append_c ((GString *) data,
+                           (gchar) output);
+    }
+
+    return TRUE;
+}
+
+static gboolean
+debug_dump (CattleInterpreter  *interpreter,
+            gpointer            data,
+            GError            **error G_GNUC_UNUSED)
+{
+    g_autoptr (CattleTape) tape = NULL;
+
+    tape = cattle_interpreter_get_tape (interpreter);
+
+    dump_tape (tape, (GString *) data);
+
+    return TRUE;
+}
+
+static void
+outcome_init (Outcome *outcome)
+{
+    outcome->success = FALSE;
+    outcome->code = -1;
+    outcome->output = g_string_new (NULL);
+    outcome->tape = g_string_new (NULL);
+    outcome->elapsed = 0.0;
+}
+
+static void
+outcome_clear (Outcome *outcome)
+{
+    g_string_free (outcome->output, TRUE);
+    g_string_free (outcome->tape, TRUE);
+}
+
+/* Run @program using Cattle */
+static void
+cattle_run (const Program       *program,
+            const Configuration *configuration,
+            Outcome             *outcome)
+{
+    g_autoptr (CattleInterpreter)   interpreter = NULL;
+    g_autoptr (CattleConfiguration) config = NULL;
+    g_autoptr (CattleProgram)       code = NULL;
+    g_autoptr (CattleBuffer)        buffer = NULL;
+    g_autoptr (CattleTape)          tape = NULL;
+    g_autoptr (GError)              error = NULL;
+    InputState                      state;
+
+    g_test_timer_start ();
+
+    interpreter = cattle_interpreter_new ();
+
+    tape = cattle_tape_new_with_backend (configuration->backend);
+    cattle_interpreter_set_tape (interpreter, tape);
+    g_clear_object (&tape);
+
+    config = cattle_interpreter_get_configuration (interpreter);
+    cattle_configuration_set_end_of_input_action (config,
+                                                  configuration->end_of_input_action);
+    cattle_configuration_set_debug_is_enabled (config,
+                                               configuration->debug_is_enabled);
+    cattle_configuration_set_cycle_detection_is_enabled (config,
+                                                         configuration->cycle_detection_is_enabled);
+
+    state.input = program->input != NULL ? program->input : "";
+    state.offset = 0;
+
+    cattle_interpreter_set_input_handler (interpreter,
+                                          input_chunks,
+                                          &state);
+    if (configuration->bulk_output)
+    {
+        cattle_interpreter_set_bulk_output_handler (interpreter,
+                                                    output_bulk,
+                                                    outcome->output);
+    }
+    else
+    {
+        cattle_interpreter_set_output_handler (interpreter,
+                                               output_single,
+                                               outcome->output);
+    }
+    cattle_interpreter_set_debug_handler (interpreter,
+                                          debug_dump,
+                                          outcome->output);
+
+    buffer = cattle_buffer_new (strlen (program->code));
+    cattle_buffer_set_contents (buffer, (gint8 *) program->code);
+
+    code = cattle_interpreter_get_program (interpreter);
+
+    if (cattle_program_load (code, buffer, &error) &&
+        cattle_interpreter_run (interpreter, &error))
+    {
+        outcome->success = TRUE;
+
+        tape = cattle_interpreter_get_tape (interpreter);
+        dump_tape (tape, outcome->tape);
+    }
+    else
+    {
+        outcome->code = error->code;
+    }
+
+    outcome->elapsed = g_test_timer_elapsed ();
+}
+
+/* Run @program using the reference evaluator */
+static void
+reference_run (const Program       *program,
+               const Configuration *configuration,
+               gulong               max_steps,
+               Outcome             *outcome)
+{
+    g_autofree gulong *jumps = NULL;
+    g_autofree gulong *stack = NULL;
+    g_autofree gint8  *cells = NULL;
+    const gchar       *input;
+    gulong             length;
+    gulong             depth;
+    gulong             steps;
+    gulong             position;
+    gulong             lower;
+    gulong             upper;
+    gulong             pc;
+    glong              brackets;
+    gint8              value;
+
+    g_test_timer_start ();
+
+    /* Code and embedded input are separated by a bang */
+    length = strcspn (program->code, "!");
+
+    brackets = 0;
+    for (pc = 0; pc < length; pc++)
+    {
+        if (program->code[pc] == '[')
+        {
+            brackets++;
+        }
+        else if (program->code[pc] == ']')
+        {
+            brackets--;
+        }
+    }
+
+    if (brackets != 0)
+    {
+        outcome->code = CATTLE_ERROR_UNBALANCED_BRACKETS;
+        outcome->elapsed = g_test_timer_elapsed ();
+
+        return;
+    }
+
+    /* Embedded input, if present, replaces runtime input */
+    input = program->input != NULL ? program->input : "";
+    if (program->code[length] == '!' && program->code[length + 1] != '\0')
+    {
+        input = program->code + length + 1;
+    }
+
+    /* Match brackets up front */
+    jumps = g_new0 (gulong, length + 1);
+    stack = g_new0 (gulong, length + 1);
+    depth = 0;
+
+    for (pc = 0; pc < length; pc++)
+    {
+        if (program->code[pc] == '[')
+        {
+            stack[depth++] = pc;
+        }
+        else if (program->code[pc] == ']')
+        {
+            g_assert_cmpuint (depth, >, 0);
+
+            depth--;
+            jumps[pc] = stack[depth];
+            jumps[stack[depth]] = pc;
+        }
+    }
+
+    cells = g_new0 (gint8, REFERENCE_TAPE_SIZE);
+    position = REFERENCE_TAPE_SIZE / 2;
+    lower = position;
+    upper = position;
+
+    for (pc = 0, steps = 0; pc < length; pc++, steps++)
+    {
+        if (steps >= max_steps)
+        {
+            outcome->code = CATTLE_ERROR_INFINITE_LOOP;
+            outcome->elapsed = g_test_timer_elapsed ();
+
+            return;
+        }
+
+        switch (program->code[pc])
+        {
+            case '+':
+
+                cells[position]++;
+                break;
+
+            case '-':
+
+                cells[position]--;
+                break;
+
+            case '>':
+
+                g_assert_cmpuint (position + 1, <, REFERENCE_TAPE_SIZE);
+
+                position++;
+                upper = MAX (upper, position);
+                break;
+
+            case '<':
+
+                g_assert_cmpuint (position, >, 0);
+
+                position--;
+                lower = MIN (lower, position);
+                break;
+
+            case ',':
+
+                value = CATTLE_EOF;
+                if (*input != '\0')
+                {
+                    value = (gint8) *input;
+                    input++;
+                }
+
+                if (value != CATTLE_EOF)
+                {
+                    cells[position] = value;
+                }
+                else if (configuration->end_of_input_action == CATTLE_END_OF_INPUT_ACTION_STORE_EOF)
+                {
+                    cells[position] = CATTLE_EOF;
+                }
+                else if (configuration->end_of_input_action == CATTLE_END_OF_INPUT_ACTION_STORE_ZERO)
+                {
+                    cells[position] = 0;
+                }
+                break;
+
+            case '.':
+
+                g_string_append_c (outcome->output,
+                                   (gchar) cells[position]);
+                break;
+
+            case '#':
+
+                if (configuration->debug_is_enabled)
+                {
+                    format_tape (outcome->output,
+                                 cells + lower,
+                                 upper - lower + 1,
+                                 position - lower);
+                }
+                break;
+
+            case '[':
+
+                if (cells[position] == 0)
+                {
+                    pc = jumps[pc];
+                }
+                break;
+
+            case ']':
+
+                if (cells[position] != 0)
+                {
+                    pc = jumps[pc];
+                }
+                break;
+
+            default:
+
+                /* Comment */
+                break;
+        }
+    }
+
+    outcome->success = TRUE;
+
+    format_tape (outcome->tape,
+                 cells + lower,
+                 upper - lower + 1,
+                 position - lower);
+
+    outcome->elapsed = g_test_timer_elapsed ();
+}
+
+/* Describe @configuration in a human-readable way */
+static gchar*
+describe (const Configuration *configuration)
+{
+    const gchar *actions[] = { "zero", "eof", "nothing" };
+    const gchar *backends[] = { "heap", "reserved", "sparse" };
+
+    return g_strdup_printf ("eof=%s debug=%s cycles=%s output=%s tape=%s",
+                            actions[configuration->end_of_input_action],
+                            configuration->debug_is_enabled ? "on" : "off",
+                            configuration->cycle_detection_is_enabled ? "on" : "off",
+                            configuration->bulk_output ? "bulk" : "single",
+                            backends[configuration->backend]);
+}
+
+/* Fill @configurations with every possible configuration.
+ * Returns the number of configurations */
+static guint
+enumerate (Configuration *configurations)
+{
+    CattleEndOfInputAction action;
+    CattleTapeBackend      backend;
+    guint                  flags;
+    guint                  count;
+
+    count = 0;
+
+    for (action = CATTLE_END_OF_INPUT_ACTION_STORE_ZERO;
+         action <= CATTLE_END_OF_INPUT_ACTION_DO_NOTHING;
+         action++)
+    {
+        for (flags = 0; flags < 8; flags++)
+        {
+            for (backend = CATTLE_TAPE_BACKEND_HEAP;
+                 backend <= CATTLE_TAPE_BACKEND_SPARSE;
+                 backend++)
+            {
+                configurations[count].end_of_input_action = action;
+                configurations[count].debug_is_enabled = (flags & 1) != 0;
+                configurations[count].cycle_detection_is_enabled = (flags & 2) != 0;
+                configurations[count].bulk_output = (flags & 4) != 0;
+                configurations[count].backend = backend;
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
+
+/* Run @program both ways and make sure the results match.
+ * Returns the time Cattle took, in seconds */
+static gdouble
+compare (const Program       *program,
+         const Configuration *configuration,
+         gulong               max_steps)
+{
+    g_autofree gchar *description = NULL;
+    Outcome           expected;
+    Outcome           actual;
+    gdouble           elapsed;
+
+    description = describe (configuration);
+
+    outcome_init (&expected);
+    outcome_init (&actual);
+
+    reference_run (program, configuration, max_steps, &expected);
+    cattle_run (program, configuration, &actual);
+
+    if (g_test_verbose ())
+    {
+        g_test_message ("%s [%s]: cattle %.6fs, reference %.6fs",
+                        program->code,
+                        description,
+                        actual.elapsed,
+                        expected.elapsed);
+    }
+
+    g_assert_cmpint (actual.success, ==, expected.success);
+    g_assert_cmpint (actual.code, ==, expected.code);
+
+    /* Output produced by programs that would run forever is not
+     * compared, because the point where they're stopped differs */
+    if (expected.code != CATTLE_ERROR_INFINITE_LOOP)
+    {
+        g_assert_cmpuint (actual.output->len, ==, expected.output->len);
+        g_assert (memcmp (actual.output->str,
+                          expected.output->str,
+                          expected.output->len) == 0);
+    }
+
+    g_assert_cmpstr (actual.tape->str, ==, expected.tape->str);
+
+    elapsed = actual.elapsed;
+
+    outcome_clear (&expected);
+    outcome_clear (&actual);
+
+    return elapsed;
+}
+
+/**
+ * test_conformance_corpus:
+ *
+ * Check Cattle behaves like the reference evaluator for every program
+ * in the corpus, under every possible configuration.
+ */
+static void
+test_conformance_corpus (void)
+{
+    Configuration configurations[72];
+    guint         count;
+    guint         i;
+    guint         j;
+
+    count = enumerate (configurations);
+
+    for (i = 0; i < count; i++)
+    {
+        g_autofree gchar *description = NULL;
+        gdouble           elapsed;
+
+        elapsed = 0.0;
+
+        for (j = 0; j < G_N_ELEMENTS (corpus); j++)
+        {
+            /* Some programs can only be stopped by cycle detection */
+            if (corpus[j].cycles_only &&
+                !configurations[i].cycle_detection_is_enabled)
+            {
+                continue;
+            }
+
+            elapsed += compare (&corpus[j],
+                                &configurations[i],
+                                CORPUS_MAX_STEPS);
+        }
+
+        description = describe (&configurations[i]);
+        g_test_message ("%s: %.6fs", description, elapsed);
+    }
+}
+
+/**
+ * test_conformance_benchmark:
+ *
+ * Time Cattle on a few longer-running programs, under every possible
+ * configuration, and check the results against the reference evaluator.
+ */
+static void
+test_conformance_benchmark (void)
+{
+    Configuration configurations[72];
+    guint         count;
+    guint         i;
+    guint         j;
+
+    count = enumerate (configurations);
+
+    for (j = 0; j < G_N_ELEMENTS (benchmarks); j++)
+    {
+        for (i = 0; i < count; i++)
+        {
+            g_autofree gchar *description = NULL;
+            gdouble           elapsed;
+
+            elapsed = compare (&benchmarks[j],
+                               &configurations[i],
+                               BENCHMARK_MAX_STEPS);
+
+            description = describe (&configurations[i]);
+            g_test_minimized_result (elapsed,
+                                     "%s [%s]: %.6fs",
+                                     benchmarks[j].code,
+                                     description,
+                                     elapsed);
+        }
+    }
+}
+
+gint
+main (gint    argc,
+      gchar **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/conformance/corpus",
+                     test_conformance_corpus);
+
+    /* Benchmarks are only run when performance tests are requested,
+     * eg. by passing -m perf to the test program */
+    if (g_test_perf ())
+    {
+        g_test_add_func ("/conformance/benchmark",
+                         test_conformance_benchmark);
+    }
+
+    return g_test_run ();
+}
@@ -22,6 +22,7 @@
 #include <glib-object.h>
 #include <cattle/cattle.h>
 #include <stdlib.h>
+#include <string.h>
 
 /* Succesful input handler */
 static gboolean
@@ -118,6 +119,37 @@ input_fail_only_error (CattleInterpreter  *interpreter G_GNUC_UNUSED,
     return TRUE;
 }
 
+/* Input streamed through a ring buffer by input_ring() */
+typedef struct
+{
+    CattleBuffer  *ring;
+    const gchar  **chunks;
+} RingInput;
+
+/* Succesful input handler that writes the next chunk of input to a
+ * ring buffer, and feeds the same buffer every time */
+static gboolean
+input_ring (CattleInterpreter  *interpreter,
+            gpointer            data,
+            GError            **error G_GNUC_UNUSED)
+{
+    RingInput *input;
+
+    input = (RingInput *) data;
+
+    if (*input->chunks != NULL)
+    {
+        cattle_buffer_write (input->ring,
+                             (gint8 *) *input->chunks,
+                             strlen (*input->chunks));
+        input->chunks++;
+    }
+
+    cattle_interpreter_feed (interpreter, input->ring);
+
+    return TRUE;
+}
+
 /* Succesfull output handler working on a buffer */
 static gboolean
 output_success_buffer (CattleInterpreter  *interpreter G_GNUC_UNUSED,
@@ -175,6 +207,48 @@ output_fail_only_error (CattleInterpreter  *interpreter G_GNUC_UNUSED,
     return TRUE;
 }
 
+/* Succesful bulk output handler working on a buffer */
+static gboolean
+bulk_output_success_buffer (CattleInterpreter  *interpreter G_GNUC_UNUSED,
+                            gint8               output,
+                            gulong              count,
+                            gpointer            data,
+                            GError            **error G_GNUC_UNUSED)
+{
+    GString *buffer;
+    gulong   i;
+
+    buffer = (GString*) data;
+
+    /* Mark the beginning of each call */
+    g_string_append_c (buffer,
+                       '|');
+
+    for (i = 0; i < count; i++)
+    {
+        g_string_append_c (buffer,
+                           (gchar) output);
+    }
+
+    return TRUE;
+}
+
+/* Unsuccesful bulk output handler that sets the error */
+static gboolean
+bulk_output_fail_set_error (CattleInterpreter  *interpreter G_GNUC_UNUSED,
+                            gint8               output G_GNUC_UNUSED,
+                            gulong              count G_GNUC_UNUSED,
+                            gpointer            data G_GNUC_UNUSED,
+                            GError            **error)
+{
+    g_set_error_literal (error,
+                         CATTLE_ERROR,
+                         CATTLE_ERROR_IO,
+                         "Spurious error");
+
+    return FALSE;
+}
+
 /* Succesfut debug handler working on a buffer */
 static gboolean
 debug_success_buffer (CattleInterpreter  *interpreter G_GNUC_UNUSED,
@@ -588,6 +662,573 @@ test_interpreter_unbalanced_brackets (void)
     g_assert (g_error_matches (error2, CATTLE_ERROR, CATTLE_ERROR_UNBALANCED_BRACKETS));
 }
 
+/**
+ * test_interpreter_infinite_loop:
+ *
+ * Check loops that never change the value of the current cell are
+ * detected, and that an error is reported only if they're entered.
+ */
+static void
+test_interpreter_infinite_loop (void)
+{
+    const gchar *forever[] = { "+[]", "+[>+<]", "+[+-]", "+[>[-]<]" };
+    const gchar *skipped[] = { "[]", "[>+<]", "+[-]", "+[>+<-]" };
+    guint        i;
+
+    for (i = 0; i < G_N_ELEMENTS (forever); i++)
+    {
+        g_autoptr (CattleInterpreter) interpreter = NULL;
+        g_autoptr (CattleProgram)     program = NULL;
+        g_autoptr (CattleBuffer)      buffer = NULL;
+        g_autoptr (GError)            error = NULL;
+        gboolean                      success;
+
+        interpreter = cattle_interpreter_new ();
+
+        buffer = cattle_buffer_new (strlen (forever[i]));
+        cattle_buffer_set_contents (buffer, (gint8 *) forever[i]);
+
+        program = cattle_interpreter_get_program (interpreter);
+        cattle_program_load (program, buffer, NULL);
+
+        success = cattle_interpreter_run (interpreter, &error);
+        g_assert (!success);
+        g_assert (g_error_matches (error, CATTLE_ERROR, CATTLE_ERROR_INFINITE_LOOP));
+    }
+
+    for (i = 0; i < G_N_ELEMENTS (skipped); i++)
+    {
+        g_autoptr (CattleInterpreter) interpreter = NULL;
+        g_autoptr (CattleProgram)     program = NULL;
+        g_autoptr (CattleBuffer)      buffer = NULL;
+        gboolean                      success;
+
+        interpreter = cattle_interpreter_new ();
+
+        buffer = cattle_buffer_new (strlen (skipped[i]));
+        cattle_buffer_set_contents (buffer, (gint8 *) skipped[i]);
+
+        program = cattle_interpreter_get_program (interpreter);
+        cattle_program_load (program, buffer, NULL);
+
+        success = cattle_interpreter_run (interpreter, NULL);
+        g_assert (success);
+    }
+
+    {
+        g_autoptr (CattleInterpreter) interpreter = NULL;
+        g_autoptr (CattleProgram)     program = NULL;
+        g_autoptr (CattleBuffer)      buffer = NULL;
+        g_autoptr (CattleInstruction) first = NULL;
+        g_autoptr (CattleInstruction) loop = NULL;
+        g_autoptr (CattleInstruction) body = NULL;
+        gboolean                      success;
+
+        interpreter = cattle_interpreter_new ();
+
+        buffer = cattle_buffer_new (5);
+        cattle_buffer_set_contents (buffer, (gint8 *) "+[-+]");
+
+        program = cattle_interpreter_get_program (interpreter);
+        cattle_program_load (program, buffer, NULL);
+
+        /* Turn the loop into "+[--+]" after it's been loaded: it's
+         * no longer infinite, and must be run as such */
+        first = cattle_program_get_instructions (program);
+        loop = cattle_instruction_get_next (first);
+        body = cattle_instruction_get_loop (loop);
+        cattle_instruction_set_quantity (body, 2);
+
+        success = cattle_interpreter_run (interpreter, NULL);
+        g_assert (success);
+    }
+}
+
+/**
+ * test_interpreter_cycle_detection:
+ *
+ * Check loops going back to a previous state are detected at runtime
+ * when cycle detection is enabled, and that terminating loops are not
+ * reported.
+ */
+static void
+test_interpreter_cycle_detection (void)
+{
+    const gchar *forever[] = { "+[+[-]+]", "+[>+<+[-]+]", "+[>+<[-]>[-<+>]<]" };
+    guint        i;
+
+    for (i = 0; i < G_N_ELEMENTS (forever); i++)
+    {
+        g_autoptr (CattleInterpreter)   interpreter = NULL;
+        g_autoptr (CattleConfiguration) configuration = NULL;
+        g_autoptr (CattleProgram)       program = NULL;
+        g_autoptr (CattleBuffer)        buffer = NULL;
+        g_autoptr (GError)              error = NULL;
+        gboolean                        success;
+
+        interpreter = cattle_interpreter_new ();
+
+        configuration = cattle_interpreter_get_configuration (interpreter);
+        cattle_configuration_set_cycle_detection_is_enabled (configuration,
+                                                             TRUE);
+
+        buffer = cattle_buffer_new (strlen (forever[i]));
+        cattle_buffer_set_contents (buffer, (gint8 *) forever[i]);
+
+        program = cattle_interpreter_get_program (interpreter);
+        cattle_program_load (program, buffer, NULL);
+
+        success = cattle_interpreter_run (interpreter, &error);
+        g_assert (!success);
+        g_assert (g_error_matches (error, CATTLE_ERROR, CATTLE_ERROR_INFINITE_LOOP));
+    }
+
+    {
+        g_autoptr (CattleInterpreter)   interpreter = NULL;
+        g_autoptr (CattleConfiguration) configuration = NULL;
+        g_autoptr (CattleProgram)       program = NULL;
+        g_autoptr (CattleBuffer)        buffer = NULL;
+        g_autoptr (GString)             output = NULL;
+        gboolean                        success;
+
+        interpreter = cattle_interpreter_new ();
+
+        configuration = cattle_interpreter_get_configuration (interpreter);
+        cattle_configuration_set_cycle_detection_is_enabled (configuration,
+                                                             TRUE);
+
+        /* Nested loops re-entered from scratch must not be mistaken
+         * for loops going around in circles */
+        buffer = cattle_buffer_new (37);
+        cattle_buffer_set_contents (buffer, (gint8 *) "++[>+++[-]<-]++++++++[>++++++++<-]>+.");
+
+        program = cattle_interpreter_get_program (interpreter);
+        cattle_program_load (program, buffer, NULL);
+
+        output = g_string_new (NULL);
+        cattle_interpreter_set_output_handler (interpreter,
+                                               output_success_buffer,
+                                               output);
+
+        success = cattle_interpreter_run (interpreter, NULL);
+        g_assert (success);
+        g_assert_cmpstr (output->str, ==, "A");
+    }
+}
+
+/**
+ * test_interpreter_conditional_loop:
+ *
+ * Check loops that can run at most once behave exactly like regular
+ * loops, both when they are entered and when they are skipped, and
+ * that they're treated as regular loops once their body changes.
+ */
+static void
+test_interpreter_conditional_loop (void)
+{
+    const gchar *programs[] = { "+++++[>++++++++[>++++++++<-]<[-]]>>+.",
+                                "[>++++++++[>++++++++<-]<[-]]>>+.",
+                                "++[>+[>+<[-]]<[-]]>>+++++++[<++++++++>-]<+.",
+                                "+[>+++++++[>+++++++++<-]>++.<<[-]]",
+                                "+[[-]>++++++++[>++++++++<-]>+.<<]" };
+    const gchar *expected[] = { "A", "\001", "A", "A", "A" };
+    guint        i;
+
+    for (i = 0; i < G_N_ELEMENTS (programs); i++)
+    {
+        g_autoptr (CattleInterpreter) interpreter = NULL;
+        g_autoptr (CattleProgram)     program = NULL;
+        g_autoptr (CattleBuffer)      buffer = NULL;
+        g_autoptr (GString)           output = NULL;
+        gboolean                      success;
+
+        interpreter = cattle_interpreter_new ();
+
+        buffer = cattle_buffer_new (strlen (programs[i]));
+        cattle_buffer_set_contents (buffer, (gint8 *) programs[i]);
+
+        program = cattle_interpreter_get_program (interpreter);
+        cattle_program_load (program, buffer, NULL);
+
+        output = g_string_new (NULL);
+        cattle_interpreter_set_output_handler (interpreter,
+                                               output_success_buffer,
+                                               output);
+
+        success = cattle_interpreter_run (interpreter, NULL);
+        g_assert (success);
+        g_assert_cmpstr (output->str, ==, expected[i]);
+    }
+
+    {
+        g_autoptr (CattleInterpreter) interpreter = NULL;
+        g_autoptr (CattleProgram)     program = NULL;
+        g_autoptr (CattleBuffer)      buffer = NULL;
+        g_autoptr (GString)           output = NULL;
+        CattleInstruction            *current;
+        CattleInstruction            *next;
+        CattleInstruction            *end;
+        gboolean                      success;
+        guint                         j;
+
+        interpreter = cattle_interpreter_new ();
+
+        buffer = cattle_buffer_new (13);
+        cattle_buffer_set_contents (buffer, (gint8 *) "++[>+<-[-]]>.");
+
+        program = cattle_interpreter_get_program (interpreter);
+        cattle_program_load (program, buffer, NULL);
+
+        /* Drop the inner loop, turning the program into "++[>+<-]>.":
+         * the outer loop can now run more than once */
+        current = cattle_program_get_instructions (program);
+        next = cattle_instruction_get_next (current);
+        g_object_unref (current);
+        current = cattle_instruction_get_loop (next);
+        g_object_unref (next);
+        for (j = 0; j < 3; j++)
+        {
+            next = cattle_instruction_get_next (current);
+            g_object_unref (current);
+            current = next;
+        }
+        g_assert (cattle_instruction_get_value (current) == CATTLE_INSTRUCTION_DECREASE);
+        next = cattle_instruction_get_next (current);
+        end = cattle_instruction_get_next (next);
+        g_assert (cattle_instruction_get_value (end) == CATTLE_INSTRUCTION_LOOP_END);
+        cattle_instruction_set_next (current, end);
+        g_object_unref (end);
+        g_object_unref (next);
+        g_object_unref (current);
+
+        output = g_string_new (NULL);
+        cattle_interpreter_set_output_handler (interpreter,
+                                               output_success_buffer,
+                                               output);
+
+        success = cattle_interpreter_run (interpreter, NULL);
+        g_assert (success);
+        g_assert_cmpstr (output->str, ==, "\002");
+    }
+}
+
+/**
+ * test_interpreter_bulk_output:
+ *
+ * Check a bulk output handler receives repeated output in a single call,
+ * that it takes precedence over a regular output handler, and that errors
+ * it reports are propagated.
+ */
+static void
+test_interpreter_bulk_output (void)
+{
+    g_autoptr (CattleInterpreter) interpreter = NULL;
+    g_autoptr (CattleProgram)     program = NULL;
+    g_autoptr (CattleBuffer)      buffer = NULL;
+    g_autoptr (GString)           output = NULL;
+    g_autoptr (GString)           ignored = NULL;
+    g_autoptr (CattleTape)        tape = NULL;
+    g_autoptr (GError)            error = NULL;
+    gboolean                      success;
+
+    interpreter = cattle_interpreter_new ();
+
+    buffer = cattle_buffer_new (21);
+    cattle_buffer_set_contents (buffer, (gint8 *) "++++++++[>++++<-]>...");
+
+    program = cattle_interpreter_get_program (interpreter);
+    cattle_program_load (program, buffer, NULL);
+
+    output = g_string_new (NULL);
+    ignored = g_string_new (NULL);
+    cattle_interpreter_set_output_handler (interpreter,
+                                           output_success_buffer,
+                                           ignored);
+    cattle_interpreter_set_bulk_output_handler (interpreter,
+                                                bulk_output_success_buffer,
+                                                output);
+
+    success = cattle_interpreter_run (interpreter, NULL);
+    g_assert (success);
+    g_assert_cmpstr (output->str, ==, "|   ");
+    g_assert_cmpuint (ignored->len, ==, 0);
+
+    /* Go back to the regular output handler */
+    cattle_interpreter_set_bulk_output_handler (interpreter,
+                                                NULL,
+                                                NULL);
+
+    tape = cattle_tape_new ();
+    cattle_interpreter_set_tape (interpreter, tape);
+
+    success = cattle_interpreter_run (interpreter, NULL);
+    g_assert (success);
+    g_assert_cmpstr (ignored->str, ==, "   ");
+
+    cattle_interpreter_set_bulk_output_handler (interpreter,
+                                                bulk_output_fail_set_error,
+                                                NULL);
+
+    success = cattle_interpreter_run (interpreter, &error);
+    g_assert (!success);
+    g_assert (g_error_matches (error, CATTLE_ERROR, CATTLE_ERROR_IO));
+}
+
+/**
+ * test_interpreter_tape_out_of_bounds:
+ *
+ * Check the correct error is reported when a program tries to move past
+ * either edge of a tape with a fixed size, or past the left edge of a
+ * tape that can't grow on the left.
+ */
+static void
+test_interpreter_tape_out_of_bounds (void)
+{
+    const gchar *programs[] = { "+<", ">>>>+[>+]", "+>>>>.", "+>><<<", ">>+<<." };
+    gboolean     fixed[] = { TRUE, TRUE, TRUE, FALSE, FALSE };
+    gboolean     succeeds[] = { FALSE, FALSE, TRUE, FALSE, TRUE };
+    guint        i;
+
+    for (i = 0; i < G_N_ELEMENTS (programs); i++)
+    {
+        g_autoptr (CattleInterpreter) interpreter = NULL;
+        g_autoptr (CattleProgram)     program = NULL;
+        g_autoptr (CattleBuffer)      buffer = NULL;
+        g_autoptr (CattleTape)        tape = NULL;
+        g_autoptr (GString)           output = NULL;
+        g_autoptr (GError)            error = NULL;
+        gboolean                      success;
+
+        interpreter = cattle_interpreter_new ();
+
+        if (fixed[i])
+        {
+            tape = cattle_tape_new_with_size (5);
+        }
+        else
+        {
+            tape = cattle_tape_new ();
+            cattle_tape_set_left_growth_is_enabled (tape, FALSE);
+        }
+        cattle_interpreter_set_tape (interpreter, tape);
+
+        buffer = cattle_buffer_new (strlen (programs[i]));
+        cattle_buffer_set_contents (buffer, (gint8 *) programs[i]);
+
+        program = cattle_interpreter_get_program (interpreter);
+        cattle_program_load (program, buffer, NULL);
+
+        output = g_string_new (NULL);
+        cattle_interpreter_set_output_handler (interpreter,
+                                               output_success_buffer,
+                                               output);
+
+        success = cattle_interpreter_run (interpreter, &error);
+
+        if (succeeds[i])
+        {
+            g_assert (success);
+            g_assert_cmpuint (output->len, ==, 1);
+            g_assert (output->str[0] == 0);
+        }
+        else
+        {
+            g_assert (!success);
+            g_assert (g_error_matches (error, CATTLE_ERROR, CATTLE_ERROR_TAPE_OUT_OF_BOUNDS));
+        }
+    }
+}
+
+/**
+ * test_interpreter_tape_memory_limit:
+ *
+ * Run a program that keeps moving right on tapes with a memory limit,
+ * and check it's stopped with the appropriate error before going over
+ * the limit.
+ */
+static void
+test_interpreter_tape_memory_limit (void)
+{
+    CattleTapeBackend backends[] = { CATTLE_TAPE_BACKEND_HEAP,
+                                     CATTLE_TAPE_BACKEND_RESERVED,
+                                     CATTLE_TAPE_BACKEND_SPARSE };
+    const gchar      *program = "+[>+]";
+    guint             i;
+
+    for (i = 0; i < G_N_ELEMENTS (backends); i++)
+    {
+        g_autoptr (CattleInterpreter) interpreter = NULL;
+        g_autoptr (CattleProgram)     program_obj = NULL;
+        g_autoptr (CattleBuffer)      buffer = NULL;
+        g_autoptr (CattleTape)        tape = NULL;
+        g_autoptr (GError)            error = NULL;
+        gboolean                      success;
+
+        interpreter = cattle_interpreter_new ();
+
+        tape = cattle_tape_new_with_backend (backends[i]);
+        cattle_tape_set_memory_limit (tape, 1024 * 1024);
+        cattle_interpreter_set_tape (interpreter, tape);
+
+        buffer = cattle_buffer_new (strlen (program));
+        cattle_buffer_set_contents (buffer, (gint8 *) program);
+
+        program_obj = cattle_interpreter_get_program (interpreter);
+        cattle_program_load (program_obj, buffer, NULL);
+
+        success = cattle_interpreter_run (interpreter, &error);
+
+        g_assert (!success);
+        g_assert (g_error_matches (error, CATTLE_ERROR, CATTLE_ERROR_TAPE_MEMORY_LIMIT));
+        g_assert_cmpuint (cattle_tape_get_memory_usage (tape), <=, 1024 * 1024);
+        g_assert_cmpuint (cattle_tape_get_peak_memory_usage (tape), <=, 1024 * 1024);
+        g_assert_cmpuint (cattle_tape_get_memory_usage (tape), >, 1000 * 1000);
+    }
+}
+
+/**
+ * test_interpreter_cell_width:
+ *
+ * Run the same program on tapes with different cell widths, and check
+ * that arithmetic, input and output are performed according to the
+ * width of the cells.
+ */
+static void
+test_interpreter_cell_width (void)
+{
+    CattleCellWidth widths[] = { CATTLE_CELL_WIDTH_8,
+                                 CATTLE_CELL_WIDTH_16,
+                                 CATTLE_CELL_WIDTH_32,
+                                 CATTLE_CELL_WIDTH_64 };
+    guint           i;
+    guint           j;
+
+    for (i = 0; i < G_N_ELEMENTS (widths); i++)
+    {
+        g_autoptr (CattleInterpreter)   interpreter = NULL;
+        g_autoptr (CattleConfiguration) configuration = NULL;
+        g_autoptr (CattleProgram)       program = NULL;
+        g_autoptr (CattleBuffer)        buffer = NULL;
+        g_autoptr (CattleTape)          tape = NULL;
+        g_autoptr (GString)             code = NULL;
+        g_autoptr (GString)             output = NULL;
+        g_autoptr (GError)              error = NULL;
+        gboolean                        wide;
+        gboolean                        success;
+
+        wide = (widths[i] != CATTLE_CELL_WIDTH_8);
+
+        /* Read a 0xff byte and the end of input, overflow 8 bits,
+         * then print a value that's only correct if no overflow
+         * happened and make the last cell negative */
+        code = g_string_new (",>,>");
+        for (j = 0; j < 256; j++)
+        {
+            g_string_append_c (code, '+');
+        }
+        g_string_append (code, "[>+<[-]]>");
+        for (j = 0; j < 64; j++)
+        {
+            g_string_append_c (code, '+');
+        }
+        g_string_append (code, ".>-!\xff");
+
+        interpreter = cattle_interpreter_new ();
+
+        configuration = cattle_interpreter_get_configuration (interpreter);
+        cattle_configuration_set_end_of_input_action (configuration,
+                                                      CATTLE_END_OF_INPUT_ACTION_STORE_EOF);
+
+        tape = cattle_tape_new_with_cell_width (widths[i]);
+        cattle_interpreter_set_tape (interpreter, tape);
+
+        buffer = cattle_buffer_new (code->len);
+        cattle_buffer_set_contents (buffer, (gint8 *) code->str);
+
+        program = cattle_interpreter_get_program (interpreter);
+        cattle_program_load (program, buffer, NULL);
+
+        output = g_string_new (NULL);
+        cattle_interpreter_set_output_handler (interpreter,
+                                               output_success_buffer,
+                                               output);
+
+        success = cattle_interpreter_run (interpreter, &error);
+
+        g_assert (success);
+        g_assert (error == NULL);
+
+        g_assert_cmpuint (output->len, ==, 1);
+        g_assert_cmpint (output->str[0], ==, wide ? 'A' : '@');
+
+        /* The whole cell is decreased */
+        g_assert_cmpint (cattle_tape_get_current_wide_value (tape), ==, -1);
+        g_assert_cmpint (cattle_tape_get_current_value (tape), ==, -1);
+
+        cattle_tape_move_left (tape);
+        g_assert_cmpint (cattle_tape_get_current_wide_value (tape), ==, wide ? 'A' : '@');
+
+        cattle_tape_move_left (tape);
+        g_assert_cmpint (cattle_tape_get_current_wide_value (tape), ==, 0);
+
+        /* End of input */
+        cattle_tape_move_left (tape);
+        g_assert_cmpint (cattle_tape_get_current_wide_value (tape), ==, CATTLE_EOF);
+
+        /* With wide cells, a 0xff byte is different from the end
+         * of input */
+        cattle_tape_move_left (tape);
+        g_assert_cmpint (cattle_tape_get_current_wide_value (tape), ==, wide ? 0xff : CATTLE_EOF);
+    }
+}
+
+/**
+ * test_interpreter_ring_input:
+ *
+ * Check an input handler can stream input through a single ring
+ * buffer.
+ */
+static void
+test_interpreter_ring_input (void)
+{
+    g_autoptr (CattleInterpreter) interpreter = NULL;
+    g_autoptr (CattleProgram)     program = NULL;
+    g_autoptr (CattleBuffer)      buffer = NULL;
+    g_autoptr (CattleBuffer)      ring = NULL;
+    g_autoptr (GString)           output = NULL;
+    g_autoptr (GError)            error = NULL;
+    const gchar                  *chunks[] = { "abc", "de", NULL };
+    RingInput                     input;
+    gboolean                      success;
+
+    interpreter = cattle_interpreter_new ();
+
+    buffer = cattle_buffer_new (11);
+    cattle_buffer_set_contents (buffer, (gint8 *) ",.,.,.,.,.,");
+
+    program = cattle_interpreter_get_program (interpreter);
+    cattle_program_load (program, buffer, NULL);
+
+    ring = cattle_buffer_new_with_mode (CATTLE_BUFFER_MODE_RING, 4);
+    input.ring = ring;
+    input.chunks = chunks;
+
+    output = g_string_new ("");
+
+    cattle_interpreter_set_input_handler (interpreter,
+                                          input_ring,
+                                          &input);
+    cattle_interpreter_set_output_handler (interpreter,
+                                           output_success_buffer,
+                                           output);
+
+    success = cattle_interpreter_run (interpreter, &error);
+    g_assert_no_error (error);
+    g_assert (success);
+    g_assert_cmpstr (output->str, ==, "abcde");
+    g_assert (cattle_buffer_get_available (ring) == 0);
+}
+
 gint
 main (gint    argc,
       gchar **argv)
@@ -608,8 +1249,24 @@ main (gint    argc,
                      test_interpreter_unicode_input);
     g_test_add_func ("/interpreter/invalid-input",
                      test_interpreter_invalid_input);
+    g_test_add_func ("/interpreter/ring-input",
+                     test_interpreter_ring_input);
     g_test_add_func ("/interpreter/unbalanced-brackets",
                      test_interpreter_unbalanced_brackets);
+    g_test_add_func ("/interpreter/infinite-loop",
+                     test_interpreter_infinite_loop);
+    g_test_add_func ("/interpreter/cycle-detection",
+                     test_interpreter_cycle_detection);
+    g_test_add_func ("/interpreter/conditional-loop",
+                     test_interpreter_conditional_loop);
+    g_test_add_func ("/interpreter/bulk-output",
+                     test_interpreter_bulk_output);
+    g_test_add_func ("/interpreter/tape-out-of-bounds",
+                     test_interpreter_tape_out_of_bounds);
+    g_test_add_func ("/interpreter/tape-memory-limit",
+                     test_interpreter_tape_memory_limit);
+    g_test_add_func ("/interpreter/cell-width",
+                     test_interpreter_cell_width);
 
     return g_test_run ();
 }
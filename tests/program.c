@@ -297,6 +297,131 @@ test_program_load_double_loop (void)
     g_assert (nothing == NULL);
 }
 
+#define PROGRAM_GROWABLE ",.!x"
+
+/**
+ * test_program_load_growable:
+ *
+ * Load a program, along with its input, from a growable buffer, and
+ * make sure ring buffers are rejected.
+ */
+static void
+test_program_load_growable (void)
+{
+    g_autoptr (CattleProgram)     program = NULL;
+    g_autoptr (CattleInstruction) instructions = NULL;
+    g_autoptr (CattleBuffer)      buffer = NULL;
+    g_autoptr (CattleBuffer)      ring = NULL;
+    g_autoptr (CattleBuffer)      input = NULL;
+    gboolean                      success;
+
+    program = cattle_program_new ();
+
+    buffer = cattle_buffer_new_with_mode (CATTLE_BUFFER_MODE_GROWABLE, 0);
+    cattle_buffer_append (buffer, (gint8 *) PROGRAM_GROWABLE, strlen (PROGRAM_GROWABLE));
+
+    success = cattle_program_load (program, buffer, NULL);
+    g_assert (success);
+
+    instructions = cattle_program_get_instructions (program);
+    g_assert (cattle_instruction_get_value (instructions) == CATTLE_INSTRUCTION_READ);
+
+    /* The input is not affected by later changes to the buffer */
+    cattle_buffer_clear (buffer);
+    cattle_buffer_append (buffer, (gint8 *) "yy", 2);
+
+    input = cattle_program_get_input (program);
+    g_assert_cmpuint (cattle_buffer_get_size (input), ==, 1);
+    g_assert_cmpint (cattle_buffer_get_value (input, 0), ==, 'x');
+
+    /* Ring buffers are not supported */
+    ring = cattle_buffer_new_with_mode (CATTLE_BUFFER_MODE_RING, 8);
+    cattle_buffer_write (ring, (gint8 *) PROGRAM_GROWABLE, strlen (PROGRAM_GROWABLE));
+
+    g_test_expect_message ("Cattle",
+                           G_LOG_LEVEL_CRITICAL,
+                           "*CATTLE_BUFFER_MODE_RING*");
+    success = cattle_program_load (program, ring, NULL);
+    g_test_assert_expected_messages ();
+
+    g_assert (!success);
+}
+
+#define PROGRAM_BOUNDED "<+>>>[<<<<<+>>>>>>>-<<]"
+#define PROGRAM_UNBOUNDED "+[>]"
+
+/**
+ * test_program_tape_extent:
+ *
+ * Check the part of the tape a program can reach is computed correctly,
+ * and that it's reported as unknown when it can't be computed.
+ */
+static void
+test_program_tape_extent (void)
+{
+    g_autoptr (CattleProgram)     program = NULL;
+    g_autoptr (CattleBuffer)      buffer1 = NULL;
+    g_autoptr (CattleBuffer)      buffer2 = NULL;
+    g_autoptr (CattleInstruction) instructions = NULL;
+    g_autoptr (CattleInstruction) first = NULL;
+    glong                         lower;
+    glong                         upper;
+    gboolean                      success;
+
+    program = cattle_program_new ();
+
+    /* An empty program doesn't move at all */
+    success = cattle_program_get_tape_extent (program, &lower, &upper);
+
+    g_assert (success);
+    g_assert_cmpint (lower, ==, 0);
+    g_assert_cmpint (upper, ==, 0);
+
+    buffer1 = cattle_buffer_new (strlen (PROGRAM_BOUNDED));
+    cattle_buffer_set_contents (buffer1, (gint8 *) PROGRAM_BOUNDED);
+
+    success = cattle_program_load (program, buffer1, NULL);
+    g_assert (success);
+
+    success = cattle_program_get_tape_extent (program, &lower, &upper);
+
+    g_assert (success);
+    g_assert_cmpint (lower, ==, -3);
+    g_assert_cmpint (upper, ==, 4);
+
+    buffer2 = cattle_buffer_new (strlen (PROGRAM_UNBOUNDED));
+    cattle_buffer_set_contents (buffer2, (gint8 *) PROGRAM_UNBOUNDED);
+
+    success = cattle_program_load (program, buffer2, NULL);
+    g_assert (success);
+
+    success = cattle_program_get_tape_extent (program, &lower, &upper);
+
+    g_assert (!success);
+
+    /* Changing any instruction after loading makes the extent unknown */
+    success = cattle_program_load (program, buffer1, NULL);
+    g_assert (success);
+
+    first = cattle_program_get_instructions (program);
+    cattle_instruction_set_quantity (first, 10);
+
+    success = cattle_program_get_tape_extent (program, NULL, NULL);
+
+    g_assert (!success);
+
+    /* Setting the instructions directly makes the extent unknown */
+    success = cattle_program_load (program, buffer1, NULL);
+    g_assert (success);
+
+    instructions = cattle_instruction_new ();
+    cattle_program_set_instructions (program, instructions);
+
+    success = cattle_program_get_tape_extent (program, NULL, NULL);
+
+    g_assert (!success);
+}
+
 gint
 main (gint argc, gchar **argv)
 {
@@ -312,6 +437,10 @@ main (gint argc, gchar **argv)
                      test_program_load_with_input);
     g_test_add_func ("/program/load-double-loop",
                      test_program_load_double_loop);
+    g_test_add_func ("/program/load-growable",
+                     test_program_load_growable);
+    g_test_add_func ("/program/tape-extent",
+                     test_program_tape_extent);
 
     return g_test_run ();
 }
@@ -20,7 +20,9 @@
 
 #include <glib.h>
 #include <glib-object.h>
+#include <glib/gstdio.h>
 #include <cattle/cattle.h>
+#include <string.h>
 
 #define STEPS 1024
 
@@ -221,6 +223,42 @@ test_tape_bookmarks (void)
     g_assert (cattle_tape_get_current_value (tape) == 42);
 }
 
+/**
+ * test_tape_nested_bookmarks:
+ *
+ * Push lots of bookmarks, making the stack grow, then pop them all in
+ * reverse order, both from the tape and from a snapshot of it.
+ */
+static void
+test_tape_nested_bookmarks (void)
+{
+    g_autoptr (CattleTape) tape = NULL;
+    g_autoptr (CattleTape) snapshot = NULL;
+    gint                   i;
+
+    tape = cattle_tape_new ();
+
+    for (i = 0; i < 100; i++)
+    {
+        cattle_tape_set_current_value (tape, i);
+        cattle_tape_push_bookmark (tape);
+        cattle_tape_move_left_by (tape, i + 1);
+    }
+
+    snapshot = cattle_tape_snapshot (tape);
+
+    for (i = 99; i >= 0; i--)
+    {
+        g_assert (cattle_tape_pop_bookmark (tape));
+        g_assert (cattle_tape_get_current_value (tape) == i);
+        g_assert (cattle_tape_pop_bookmark (snapshot));
+        g_assert (cattle_tape_get_current_value (snapshot) == i);
+    }
+
+    g_assert (!cattle_tape_pop_bookmark (tape));
+    g_assert (!cattle_tape_pop_bookmark (snapshot));
+}
+
 /**
  * test_tape_current_value:
  *
@@ -366,6 +404,1083 @@ test_tape_negative_wrap (void)
     g_assert (cattle_tape_get_current_value (tape) == 42);
 }
 
+/**
+ * test_tape_reserve:
+ *
+ * Reserving memory must not change the edges of the tape nor its
+ * contents, and the tape must be usable across reserved cells.
+ */
+static void
+test_tape_reserve (void)
+{
+    g_autoptr (CattleTape) tape = NULL;
+    gint                   i;
+
+    tape = cattle_tape_new ();
+
+    cattle_tape_set_current_value (tape, 42);
+    cattle_tape_reserve (tape, STEPS, STEPS);
+
+    g_assert (cattle_tape_is_at_beginning (tape));
+    g_assert (cattle_tape_is_at_end (tape));
+    g_assert (cattle_tape_get_current_value (tape) == 42);
+
+    /* Move to the left edge of the reserved area and back */
+    for (i = 0; i < STEPS; i++)
+    {
+        cattle_tape_move_left (tape);
+
+        g_assert (cattle_tape_is_at_beginning (tape));
+        g_assert (!cattle_tape_is_at_end (tape));
+        g_assert (cattle_tape_get_current_value (tape) == 0);
+    }
+    cattle_tape_move_right_by (tape, STEPS);
+
+    g_assert (!cattle_tape_is_at_beginning (tape));
+    g_assert (cattle_tape_is_at_end (tape));
+    g_assert (cattle_tape_get_current_value (tape) == 42);
+
+    /* Move past the right edge of the reserved area */
+    for (i = 0; i < 2 * STEPS; i++)
+    {
+        cattle_tape_move_right (tape);
+
+        g_assert (!cattle_tape_is_at_beginning (tape));
+        g_assert (cattle_tape_is_at_end (tape));
+        g_assert (cattle_tape_get_current_value (tape) == 0);
+    }
+}
+
+/**
+ * test_tape_growth:
+ *
+ * Check the contents of the tape and the bookmarks are preserved when
+ * the tape has to grow, on either side, by a large amount at once.
+ */
+static void
+test_tape_growth (void)
+{
+    g_autoptr (CattleTape) tape = NULL;
+    gint                   i;
+
+    tape = cattle_tape_new ();
+
+    /* Leave a trail of values and bookmarks behind */
+    for (i = 0; i < 10; i++)
+    {
+        cattle_tape_set_current_value (tape, i + 1);
+        cattle_tape_push_bookmark (tape);
+        cattle_tape_move_right (tape);
+    }
+
+    /* Force the tape to grow in both directions */
+    cattle_tape_move_left_by (tape, 100 * STEPS);
+    g_assert (cattle_tape_is_at_beginning (tape));
+    g_assert (cattle_tape_get_current_value (tape) == 0);
+    cattle_tape_set_current_value (tape, -1);
+
+    cattle_tape_move_right_by (tape, 200 * STEPS);
+    g_assert (cattle_tape_is_at_end (tape));
+    g_assert (cattle_tape_get_current_value (tape) == 0);
+    cattle_tape_set_current_value (tape, -2);
+
+    /* All bookmarks must still point to the same cells */
+    for (i = 10; i > 0; i--)
+    {
+        g_assert (cattle_tape_pop_bookmark (tape));
+        g_assert (cattle_tape_get_current_value (tape) == i);
+        g_assert (!cattle_tape_is_at_beginning (tape));
+        g_assert (!cattle_tape_is_at_end (tape));
+    }
+    g_assert (!cattle_tape_pop_bookmark (tape));
+
+    /* Both edges must still be where they were */
+    cattle_tape_move_left_by (tape, 100 * STEPS - 10);
+    g_assert (cattle_tape_is_at_beginning (tape));
+    g_assert (cattle_tape_get_current_value (tape) == -1);
+
+    cattle_tape_move_right_by (tape, 200 * STEPS);
+    g_assert (cattle_tape_is_at_end (tape));
+    g_assert (cattle_tape_get_current_value (tape) == -2);
+}
+
+/**
+ * test_tape_fixed_size:
+ *
+ * Check a tape with a fixed size starts on its first cell, and that
+ * moving past either one of its edges fails without moving the tape.
+ */
+static void
+test_tape_fixed_size (void)
+{
+    g_autoptr (CattleTape) tape = NULL;
+
+    tape = cattle_tape_new_with_size (STEPS);
+    g_assert_cmpuint (cattle_tape_get_size (tape), ==, STEPS);
+
+    g_assert (cattle_tape_is_at_beginning (tape));
+    g_assert (cattle_tape_is_at_end (tape));
+
+    /* No room on the left */
+    cattle_tape_set_current_value (tape, 42);
+    g_assert (!cattle_tape_move_left (tape));
+    g_assert (cattle_tape_get_current_value (tape) == 42);
+
+    /* Reach the last cell */
+    g_assert (cattle_tape_move_right_by (tape, STEPS - 1));
+    g_assert (cattle_tape_is_at_end (tape));
+    cattle_tape_set_current_value (tape, 1);
+
+    /* No room on the right */
+    g_assert (!cattle_tape_move_right (tape));
+    g_assert (!cattle_tape_move_right_by (tape, STEPS));
+    g_assert (cattle_tape_get_current_value (tape) == 1);
+
+    /* Go back to the first cell, but not past it */
+    g_assert (!cattle_tape_move_left_by (tape, STEPS));
+    g_assert (cattle_tape_move_left_by (tape, STEPS - 1));
+    g_assert (cattle_tape_is_at_beginning (tape));
+    g_assert (cattle_tape_get_current_value (tape) == 42);
+
+    /* Tapes that can grow have no fixed size */
+    g_object_unref (tape);
+    tape = cattle_tape_new ();
+    g_assert_cmpuint (cattle_tape_get_size (tape), ==, 0);
+}
+
+/**
+ * test_tape_left_growth:
+ *
+ * Check a tape that can't grow on the left refuses to move past its
+ * first cell, while still growing on the right.
+ */
+static void
+test_tape_left_growth (void)
+{
+    g_autoptr (CattleTape) tape = NULL;
+    gulong                 usage;
+
+    tape = cattle_tape_new ();
+    g_assert (cattle_tape_get_left_growth_is_enabled (tape));
+
+    /* Cells already reached on the left can still be used */
+    cattle_tape_move_left_by (tape, 10);
+    cattle_tape_set_current_value (tape, 42);
+    cattle_tape_move_right_by (tape, 10);
+
+    cattle_tape_set_left_growth_is_enabled (tape, FALSE);
+    g_assert (!cattle_tape_get_left_growth_is_enabled (tape));
+
+    g_assert (!cattle_tape_move_left_by (tape, 11));
+    g_assert (cattle_tape_move_left_by (tape, 10));
+    g_assert (cattle_tape_is_at_beginning (tape));
+    g_assert (cattle_tape_get_current_value (tape) == 42);
+    g_assert (!cattle_tape_move_left (tape));
+    g_assert (cattle_tape_get_current_value (tape) == 42);
+
+    /* The right side is not affected */
+    g_assert (cattle_tape_move_right_by (tape, STEPS));
+    g_assert (cattle_tape_is_at_end (tape));
+    g_assert (cattle_tape_move_left_by (tape, STEPS));
+    g_assert (cattle_tape_is_at_beginning (tape));
+
+    /* Once enabled again, the tape grows as usual */
+    cattle_tape_set_left_growth_is_enabled (tape, TRUE);
+    g_assert (cattle_tape_move_left (tape));
+    g_assert (cattle_tape_is_at_beginning (tape));
+    g_assert (cattle_tape_get_current_value (tape) == 0);
+    g_object_unref (tape);
+
+    /* Tapes that can't grow on the left start on their first cell,
+     * so all of their memory can be used moving right */
+    tape = cattle_tape_new ();
+    cattle_tape_set_left_growth_is_enabled (tape, FALSE);
+    cattle_tape_set_current_value (tape, 42);
+    cattle_tape_push_bookmark (tape);
+    usage = cattle_tape_get_memory_usage (tape);
+    g_assert (cattle_tape_move_right_by (tape, usage - 1));
+    g_assert (cattle_tape_get_memory_usage (tape) == usage);
+    g_assert (cattle_tape_pop_bookmark (tape));
+    g_assert (cattle_tape_get_current_value (tape) == 42);
+    g_assert (!cattle_tape_move_left (tape));
+    g_object_unref (tape);
+
+    tape = g_object_new (CATTLE_TYPE_TAPE,
+                         "backend", CATTLE_TAPE_BACKEND_RESERVED,
+                         "left-growth-is-enabled", FALSE,
+                         NULL);
+    cattle_tape_set_current_value (tape, 42);
+    g_assert (cattle_tape_move_right_by (tape, STEPS));
+    g_assert (cattle_tape_move_left_by (tape, STEPS));
+    g_assert (cattle_tape_is_at_beginning (tape));
+    g_assert (!cattle_tape_move_left (tape));
+    g_assert (cattle_tape_get_current_value (tape) == 42);
+}
+
+/**
+ * test_tape_reserved_backend:
+ *
+ * Check a tape using the reserved backend behaves like any other tape
+ * while growing in both directions, and that it fails to move instead
+ * of growing past the address space it has reserved.
+ */
+static void
+test_tape_reserved_backend (void)
+{
+    g_autoptr (CattleTape) tape = NULL;
+    gulong                 distance;
+
+    tape = cattle_tape_new ();
+    g_assert (cattle_tape_get_backend (tape) == CATTLE_TAPE_BACKEND_HEAP);
+    g_object_unref (tape);
+
+    tape = cattle_tape_new_with_backend (CATTLE_TAPE_BACKEND_RESERVED);
+
+    /* Cover many pages on both sides of the origin */
+    distance = STEPS * 1024;
+
+    cattle_tape_set_current_value (tape, 42);
+    cattle_tape_push_bookmark (tape);
+
+    g_assert (cattle_tape_move_right_by (tape, distance));
+    g_assert (cattle_tape_is_at_end (tape));
+    g_assert (cattle_tape_get_current_value (tape) == 0);
+    cattle_tape_set_current_value (tape, 1);
+
+    g_assert (cattle_tape_move_left_by (tape, 2 * distance));
+    g_assert (cattle_tape_is_at_beginning (tape));
+    g_assert (cattle_tape_get_current_value (tape) == 0);
+    cattle_tape_set_current_value (tape, 2);
+
+    g_assert (cattle_tape_pop_bookmark (tape));
+    g_assert (cattle_tape_get_current_value (tape) == 42);
+
+    g_assert (cattle_tape_move_right_by (tape, distance));
+    g_assert (cattle_tape_is_at_end (tape));
+    g_assert (cattle_tape_get_current_value (tape) == 1);
+
+    /* Moving past the reserved address space fails */
+    if (cattle_tape_get_backend (tape) == CATTLE_TAPE_BACKEND_RESERVED)
+    {
+        g_assert (!cattle_tape_move_right_by (tape, G_MAXULONG / 2));
+        g_assert (cattle_tape_is_at_end (tape));
+        g_assert (cattle_tape_get_current_value (tape) == 1);
+
+        g_assert (!cattle_tape_move_left_by (tape, G_MAXULONG / 2));
+        g_assert (cattle_tape_get_current_value (tape) == 1);
+    }
+
+    /* Fixed-size tapes don't use the reserved backend */
+    g_object_unref (tape);
+    tape = g_object_new (CATTLE_TYPE_TAPE,
+                         "size", (gulong) STEPS,
+                         "backend", CATTLE_TAPE_BACKEND_RESERVED,
+                         NULL);
+    g_assert (cattle_tape_get_backend (tape) == CATTLE_TAPE_BACKEND_HEAP);
+}
+
+/**
+ * test_tape_sparse_backend:
+ *
+ * Check a tape using the sparse backend can move very far away from
+ * the origin, and that values written to it survive pages which only
+ * contain zeros being freed.
+ */
+static void
+test_tape_sparse_backend (void)
+{
+    g_autoptr (CattleTape) tape = NULL;
+    gulong                 distance;
+    gulong                 i;
+
+    tape = cattle_tape_new_with_backend (CATTLE_TAPE_BACKEND_SPARSE);
+    g_assert (cattle_tape_get_backend (tape) == CATTLE_TAPE_BACKEND_SPARSE);
+
+    /* Much farther than any other backend could go without
+     * allocating lots of memory */
+    distance = G_MAXULONG / 8;
+
+    cattle_tape_set_current_value (tape, 42);
+    g_assert (cattle_tape_move_right_by (tape, distance));
+    g_assert (cattle_tape_is_at_end (tape));
+    g_assert (cattle_tape_get_current_value (tape) == 0);
+    cattle_tape_set_current_value (tape, 1);
+    g_assert (cattle_tape_move_left_by (tape, 2 * distance));
+    g_assert (cattle_tape_is_at_beginning (tape));
+    g_assert (cattle_tape_get_current_value (tape) == 0);
+    cattle_tape_set_current_value (tape, 2);
+
+    /* Touch lots of pages, leaving every other one zeroed, so that
+     * they get freed along the way */
+    for (i = 0; i < 256; i++)
+    {
+        g_assert (cattle_tape_move_right_by (tape, STEPS * 64));
+        cattle_tape_increase_current_value (tape);
+        if (i % 2 == 0)
+        {
+            cattle_tape_decrease_current_value (tape);
+        }
+    }
+
+    for (i = 256; i > 0; i--)
+    {
+        g_assert (cattle_tape_get_current_value (tape) == (i % 2 == 0 ? 1 : 0));
+        g_assert (cattle_tape_move_left_by (tape, STEPS * 64));
+    }
+
+    g_assert (cattle_tape_is_at_beginning (tape));
+    g_assert (cattle_tape_get_current_value (tape) == 2);
+    g_assert (cattle_tape_move_right_by (tape, distance));
+    g_assert (cattle_tape_get_current_value (tape) == 42);
+    g_assert (cattle_tape_move_right_by (tape, distance));
+    g_assert (cattle_tape_is_at_end (tape));
+    g_assert (cattle_tape_get_current_value (tape) == 1);
+}
+
+/**
+ * test_tape_cell_width:
+ *
+ * Check values are stored, truncated and wrapped around according to
+ * the width of the cells, and that they survive the tape growing.
+ */
+static void
+test_tape_cell_width (void)
+{
+    CattleCellWidth   widths[] = { CATTLE_CELL_WIDTH_8,
+                                   CATTLE_CELL_WIDTH_16,
+                                   CATTLE_CELL_WIDTH_32,
+                                   CATTLE_CELL_WIDTH_64 };
+    gint64            maximums[] = { G_MAXINT8,
+                                     G_MAXINT16,
+                                     G_MAXINT32,
+                                     G_MAXINT64 };
+    CattleTapeBackend backends[] = { CATTLE_TAPE_BACKEND_RESERVED,
+                                     CATTLE_TAPE_BACKEND_SPARSE };
+    guint             i;
+    guint             j;
+
+    for (i = 0; i < G_N_ELEMENTS (widths); i++)
+    {
+        g_autoptr (CattleTape) tape = NULL;
+        gint64                 maximum;
+
+        maximum = maximums[i];
+
+        tape = cattle_tape_new_with_cell_width (widths[i]);
+        g_assert (cattle_tape_get_cell_width (tape) == widths[i]);
+
+        /* Narrow values are sign-extended */
+        cattle_tape_set_current_value (tape, -1);
+        g_assert_cmpint (cattle_tape_get_current_wide_value (tape), ==, -1);
+
+        /* Arithmetic wraps around at the width of the cell */
+        cattle_tape_set_current_wide_value (tape, maximum);
+        g_assert_cmpint (cattle_tape_get_current_wide_value (tape), ==, maximum);
+        cattle_tape_increase_current_value (tape);
+        g_assert_cmpint (cattle_tape_get_current_wide_value (tape), ==, -maximum - 1);
+        cattle_tape_decrease_current_value_by (tape, 2);
+        g_assert_cmpint (cattle_tape_get_current_wide_value (tape), ==, maximum - 1);
+
+        /* Only the lowest 8 bits are returned as a narrow value */
+        cattle_tape_set_current_wide_value (tape, 0x141);
+        g_assert_cmpint (cattle_tape_get_current_value (tape), ==, 0x41);
+
+        /* Values larger than the cell are truncated */
+        cattle_tape_set_current_wide_value (tape, G_MAXINT64);
+        g_assert_cmpint (cattle_tape_get_current_wide_value (tape), ==,
+                         maximum == G_MAXINT64 ? G_MAXINT64 : -1);
+
+        /* Grow the tape in both directions */
+        cattle_tape_move_right_by (tape, STEPS);
+        cattle_tape_set_current_wide_value (tape, maximum);
+        cattle_tape_move_left_by (tape, 2 * STEPS);
+        cattle_tape_set_current_wide_value (tape, -maximum);
+
+        cattle_tape_move_right_by (tape, STEPS);
+        g_assert_cmpint (cattle_tape_get_current_wide_value (tape), ==,
+                         maximum == G_MAXINT64 ? G_MAXINT64 : -1);
+        cattle_tape_move_right_by (tape, STEPS);
+        g_assert_cmpint (cattle_tape_get_current_wide_value (tape), ==, maximum);
+        cattle_tape_move_left_by (tape, 2 * STEPS);
+        g_assert_cmpint (cattle_tape_get_current_wide_value (tape), ==, -maximum);
+
+        /* Same thing for the other backends */
+        for (j = 0; j < G_N_ELEMENTS (backends); j++)
+        {
+            g_object_unref (tape);
+            tape = g_object_new (CATTLE_TYPE_TAPE,
+                                 "backend", backends[j],
+                                 "cell-width", widths[i],
+                                 NULL);
+
+            cattle_tape_move_right_by (tape, STEPS * 1024);
+            cattle_tape_set_current_wide_value (tape, maximum);
+            cattle_tape_move_left_by (tape, STEPS * 2048);
+            cattle_tape_set_current_wide_value (tape, -maximum);
+
+            cattle_tape_move_right_by (tape, STEPS * 2048);
+            g_assert_cmpint (cattle_tape_get_current_wide_value (tape), ==, maximum);
+            cattle_tape_move_left_by (tape, STEPS * 2048);
+            g_assert_cmpint (cattle_tape_get_current_wide_value (tape), ==, -maximum);
+        }
+    }
+}
+
+/**
+ * test_tape_snapshot:
+ *
+ * Check changes made to a tape after taking a snapshot don't affect the
+ * snapshot, and vice versa, for all backends and for fixed-size tapes.
+ */
+static void
+test_tape_snapshot (void)
+{
+    CattleTapeBackend backends[] = { CATTLE_TAPE_BACKEND_HEAP,
+                                     CATTLE_TAPE_BACKEND_RESERVED,
+                                     CATTLE_TAPE_BACKEND_SPARSE };
+    guint             i;
+
+    for (i = 0; i <= G_N_ELEMENTS (backends); i++)
+    {
+        g_autoptr (CattleTape) tape = NULL;
+        g_autoptr (CattleTape) snapshot = NULL;
+        g_autoptr (CattleTape) other = NULL;
+
+        if (i < G_N_ELEMENTS (backends))
+        {
+            tape = cattle_tape_new_with_backend (backends[i]);
+        }
+        else
+        {
+            tape = cattle_tape_new_with_size (4 * STEPS);
+        }
+
+        cattle_tape_set_current_value (tape, 1);
+        cattle_tape_move_right_by (tape, STEPS);
+        cattle_tape_set_current_value (tape, 2);
+        cattle_tape_push_bookmark (tape);
+
+        snapshot = cattle_tape_snapshot (tape);
+        g_assert (cattle_tape_get_backend (snapshot) == cattle_tape_get_backend (tape));
+        g_assert (cattle_tape_get_size (snapshot) == cattle_tape_get_size (tape));
+
+        /* The snapshot starts in the same state */
+        g_assert_cmpint (cattle_tape_get_current_value (snapshot), ==, 2);
+        g_assert (cattle_tape_is_at_end (snapshot));
+
+        /* Writing to the original tape doesn't affect the snapshot */
+        cattle_tape_set_current_value (tape, 3);
+        g_assert_cmpint (cattle_tape_get_current_value (snapshot), ==, 2);
+
+        /* Take another snapshot, then write to the first one */
+        other = cattle_tape_snapshot (tape);
+        cattle_tape_move_left_by (snapshot, STEPS);
+        cattle_tape_increase_current_value (snapshot);
+        g_assert_cmpint (cattle_tape_get_current_value (snapshot), ==, 2);
+
+        /* Growing the snapshot doesn't affect the other tapes either */
+        cattle_tape_move_right_by (snapshot, 3 * STEPS);
+        cattle_tape_set_current_value (snapshot, 4);
+
+        g_assert (cattle_tape_pop_bookmark (snapshot));
+        g_assert_cmpint (cattle_tape_get_current_value (snapshot), ==, 2);
+        g_assert (!cattle_tape_pop_bookmark (snapshot));
+
+        g_assert_cmpint (cattle_tape_get_current_value (tape), ==, 3);
+        g_assert_cmpint (cattle_tape_get_current_value (other), ==, 3);
+        cattle_tape_move_left_by (tape, STEPS);
+        g_assert_cmpint (cattle_tape_get_current_value (tape), ==, 1);
+        g_assert (cattle_tape_pop_bookmark (other));
+        g_assert (cattle_tape_move_right_by (other, 2 * STEPS));
+        g_assert_cmpint (cattle_tape_get_current_value (other), ==, 0);
+
+        /* The original tape outlives its snapshots */
+        g_clear_object (&snapshot);
+        g_clear_object (&other);
+        cattle_tape_increase_current_value (tape);
+        g_assert_cmpint (cattle_tape_get_current_value (tape), ==, 2);
+    }
+}
+
+/**
+ * test_tape_snapshot_fork:
+ *
+ * Check many snapshots of a sparse tape, each one writing to a different
+ * page, stay independent from each other and from the original tape.
+ * This is the use case sparse tapes are recommended for.
+ */
+static void
+test_tape_snapshot_fork (void)
+{
+    g_autoptr (CattleTape) tape = NULL;
+    CattleTape            *forks[16];
+    gulong                 i;
+    gulong                 j;
+
+    tape = cattle_tape_new_with_backend (CATTLE_TAPE_BACKEND_SPARSE);
+
+    /* Spread some values over several pages */
+    for (i = 0; i < G_N_ELEMENTS (forks); i++)
+    {
+        cattle_tape_set_current_value (tape, (gint8) (i + 1));
+        g_assert (cattle_tape_move_right_by (tape, 4 * STEPS));
+    }
+    g_assert (cattle_tape_move_left_by (tape, G_N_ELEMENTS (forks) * 4 * STEPS));
+
+    /* Each fork changes a different value */
+    for (i = 0; i < G_N_ELEMENTS (forks); i++)
+    {
+        forks[i] = cattle_tape_snapshot (tape);
+        g_assert (cattle_tape_move_right_by (forks[i], i * 4 * STEPS));
+        cattle_tape_set_current_value (forks[i], 100);
+        g_assert (cattle_tape_move_left_by (forks[i], i * 4 * STEPS));
+    }
+
+    for (i = 0; i < G_N_ELEMENTS (forks); i++)
+    {
+        for (j = 0; j < G_N_ELEMENTS (forks); j++)
+        {
+            if (i == j)
+                g_assert_cmpint (cattle_tape_get_current_value (forks[i]), ==, 100);
+            else
+                g_assert_cmpint (cattle_tape_get_current_value (forks[i]), ==, (gint8) (j + 1));
+            g_assert (cattle_tape_move_right_by (forks[i], 4 * STEPS));
+        }
+
+        g_object_unref (forks[i]);
+    }
+
+    /* The original tape is unaffected */
+    for (i = 0; i < G_N_ELEMENTS (forks); i++)
+    {
+        g_assert_cmpint (cattle_tape_get_current_value (tape), ==, (gint8) (i + 1));
+        g_assert (cattle_tape_move_right_by (tape, 4 * STEPS));
+    }
+}
+
+/**
+ * test_tape_range:
+ *
+ * Copy ranges of cells to and from tapes using all backends and cell
+ * widths, and access them directly when possible.
+ */
+static void
+test_tape_range (void)
+{
+    CattleTapeBackend backends[] = { CATTLE_TAPE_BACKEND_HEAP,
+                                     CATTLE_TAPE_BACKEND_RESERVED,
+                                     CATTLE_TAPE_BACKEND_SPARSE };
+    guint             i;
+    gint              j;
+
+    for (i = 0; i < G_N_ELEMENTS (backends); i++)
+    {
+        g_autoptr (CattleTape) tape = NULL;
+        g_autoptr (CattleTape) snapshot = NULL;
+        g_autofree gint8      *data = NULL;
+        g_autofree gint8      *copy = NULL;
+        const gint8           *view;
+        gint32                 wide[3] = { -1, 0x10000, 42 };
+        gint32                 wide_copy[4];
+
+        tape = cattle_tape_new_with_backend (backends[i]);
+        data = g_new (gint8, 3 * STEPS);
+        copy = g_new (gint8, 3 * STEPS);
+
+        for (j = 0; j < 3 * STEPS; j++)
+        {
+            data[j] = (gint8) j;
+        }
+
+        /* Store values on both sides of the current cell, making the
+         * tape grow without moving it */
+        g_assert (cattle_tape_set_range (tape, -STEPS, 3 * STEPS, data));
+        g_assert_cmpint (cattle_tape_get_current_value (tape), ==, (gint8) STEPS);
+        g_assert (!cattle_tape_is_at_beginning (tape));
+        g_assert (!cattle_tape_is_at_end (tape));
+
+        cattle_tape_get_range (tape, -STEPS, 3 * STEPS, copy);
+        g_assert (memcmp (data, copy, 3 * STEPS) == 0);
+
+        g_assert (cattle_tape_move_left_by (tape, STEPS));
+        g_assert (cattle_tape_is_at_beginning (tape));
+        g_assert_cmpint (cattle_tape_get_current_value (tape), ==, 0);
+        g_assert (cattle_tape_move_right_by (tape, 3 * STEPS - 1));
+        g_assert (cattle_tape_is_at_end (tape));
+        g_assert_cmpint (cattle_tape_get_current_value (tape), ==, (gint8) (3 * STEPS - 1));
+
+        /* Cells that don't exist read as zero */
+        cattle_tape_get_range (tape, -1, 3, copy);
+        g_assert_cmpint (copy[0], ==, (gint8) (3 * STEPS - 2));
+        g_assert_cmpint (copy[1], ==, (gint8) (3 * STEPS - 1));
+        g_assert_cmpint (copy[2], ==, 0);
+
+        /* Valid cells can be accessed directly, at least a few at a
+         * time; other ones can't */
+        view = cattle_tape_peek_range (tape, -2, 3);
+        g_assert (view != NULL);
+        g_assert (memcmp (view, data + 3 * STEPS - 3, 3) == 0);
+        g_assert (cattle_tape_peek_range (tape, 0, 2) == NULL);
+        g_assert (cattle_tape_peek_range (tape, -3 * STEPS, 1) == NULL);
+
+        if (backends[i] != CATTLE_TAPE_BACKEND_SPARSE)
+        {
+            view = cattle_tape_peek_range (tape, 1 - 3 * STEPS, 3 * STEPS);
+            g_assert (view != NULL);
+            g_assert (memcmp (view, data, 3 * STEPS) == 0);
+        }
+
+        /* Writing to a snapshot doesn't affect the original tape */
+        snapshot = cattle_tape_snapshot (tape);
+        memset (data, 0x7f, STEPS);
+        g_assert (cattle_tape_set_range (snapshot, -STEPS, STEPS, data));
+        cattle_tape_get_range (tape, -STEPS, STEPS, copy);
+        g_assert_cmpint (copy[0], ==, (gint8) (2 * STEPS - 1));
+        cattle_tape_get_range (snapshot, -STEPS, STEPS, copy);
+        g_assert_cmpint (copy[0], ==, 0x7f);
+
+        /* Wide cells take more than one byte each */
+        g_clear_object (&tape);
+        tape = g_object_new (CATTLE_TYPE_TAPE,
+                             "backend", backends[i],
+                             "cell-width", CATTLE_CELL_WIDTH_32,
+                             NULL);
+
+        g_assert (cattle_tape_set_range (tape, 1, 3, wide));
+        cattle_tape_get_range (tape, 0, 4, wide_copy);
+        g_assert_cmpint (wide_copy[0], ==, 0);
+        g_assert (memcmp (wide, wide_copy + 1, sizeof (wide)) == 0);
+        cattle_tape_move_right_by (tape, 2);
+        g_assert_cmpint (cattle_tape_get_current_wide_value (tape), ==, 0x10000);
+    }
+}
+
+/**
+ * test_tape_range_edges:
+ *
+ * Check ranges can't be stored past the edges of tapes that can't
+ * grow, and that failing to store them doesn't change the tape.
+ */
+static void
+test_tape_range_edges (void)
+{
+    g_autoptr (CattleTape) tape = NULL;
+    gint8                  data[4] = { 1, 2, 3, 4 };
+    gint8                  copy[4];
+
+    tape = cattle_tape_new_with_size (4);
+
+    g_assert (!cattle_tape_set_range (tape, -1, 2, data));
+    g_assert (!cattle_tape_set_range (tape, 1, 4, data));
+    g_assert (cattle_tape_is_at_end (tape));
+    g_assert (cattle_tape_set_range (tape, 0, 4, data));
+    g_assert (!cattle_tape_is_at_end (tape));
+    cattle_tape_get_range (tape, 0, 4, copy);
+    g_assert (memcmp (data, copy, 4) == 0);
+
+    g_clear_object (&tape);
+    tape = cattle_tape_new ();
+    cattle_tape_set_left_growth_is_enabled (tape, FALSE);
+
+    g_assert (!cattle_tape_set_range (tape, -1, 2, data));
+    g_assert (cattle_tape_set_range (tape, 0, 4, data));
+    g_assert (cattle_tape_move_right (tape));
+    g_assert (cattle_tape_set_range (tape, -1, 4, data));
+    g_assert (cattle_tape_move_left (tape));
+    g_assert (cattle_tape_is_at_beginning (tape));
+    g_assert_cmpint (cattle_tape_get_current_value (tape), ==, 1);
+}
+
+/**
+ * test_tape_memory_limit:
+ *
+ * Check tapes using any backend don't grow past their memory limit,
+ * and that memory usage is accounted for correctly.
+ */
+static void
+test_tape_memory_limit (void)
+{
+    CattleTapeBackend backends[] = { CATTLE_TAPE_BACKEND_HEAP,
+                                     CATTLE_TAPE_BACKEND_RESERVED,
+                                     CATTLE_TAPE_BACKEND_SPARSE };
+    guint             i;
+    gulong            steps;
+    gulong            peak;
+
+    for (i = 0; i < G_N_ELEMENTS (backends); i++)
+    {
+        g_autoptr (CattleTape) tape = NULL;
+        g_autoptr (CattleTape) snapshot = NULL;
+        g_autofree gint8      *data = NULL;
+
+        tape = cattle_tape_new_with_backend (backends[i]);
+        g_assert_cmpuint (cattle_tape_get_memory_limit (tape), ==, 0);
+        g_assert_cmpuint (cattle_tape_get_peak_memory_usage (tape), ==,
+                          cattle_tape_get_memory_usage (tape));
+
+        cattle_tape_set_memory_limit (tape, 64 * STEPS);
+        g_assert_cmpuint (cattle_tape_get_memory_limit (tape), ==, 64 * STEPS);
+
+        /* Move right until the limit is reached */
+        for (steps = 0; cattle_tape_move_right (tape); steps++)
+        {
+            cattle_tape_set_current_value (tape, 1);
+            g_assert_cmpuint (cattle_tape_get_memory_usage (tape), <=, 64 * STEPS);
+        }
+        g_assert_cmpuint (steps, >, 32 * STEPS);
+        g_assert (cattle_tape_is_at_end (tape));
+        g_assert_cmpint (cattle_tape_get_current_value (tape), ==, 1);
+
+        /* Other ways of growing fail too */
+        g_assert (!cattle_tape_move_right_by (tape, 64 * STEPS));
+        data = g_new0 (gint8, 64 * STEPS);
+        g_assert (!cattle_tape_set_range (tape, 1, 64 * STEPS, data));
+        cattle_tape_reserve (tape, 0, 64 * STEPS);
+        g_assert_cmpuint (cattle_tape_get_memory_usage (tape), <=, 64 * STEPS);
+
+        peak = cattle_tape_get_peak_memory_usage (tape);
+        g_assert_cmpuint (peak, <=, 64 * STEPS);
+        g_assert_cmpuint (peak, >=, cattle_tape_get_memory_usage (tape));
+
+        /* Snapshots inherit the limit */
+        snapshot = cattle_tape_snapshot (tape);
+        g_assert_cmpuint (cattle_tape_get_memory_limit (snapshot), ==, 64 * STEPS);
+        g_assert (!cattle_tape_move_right_by (snapshot, 64 * STEPS));
+
+        /* Raising the limit allows the tape to grow again */
+        cattle_tape_set_memory_limit (tape, 0);
+        g_assert (cattle_tape_move_right_by (tape, 64 * STEPS));
+        cattle_tape_set_current_value (tape, 1);
+        g_assert_cmpuint (cattle_tape_get_memory_usage (tape), >, 64 * STEPS);
+        g_assert_cmpuint (cattle_tape_get_peak_memory_usage (tape), >, peak);
+    }
+}
+
+/**
+ * test_tape_reset:
+ *
+ * Check resetting a tape clears all cells and bookmarks and restores
+ * the initial position, without freeing memory, for all backends.
+ */
+static void
+test_tape_reset (void)
+{
+    CattleTapeBackend backends[] = { CATTLE_TAPE_BACKEND_HEAP,
+                                     CATTLE_TAPE_BACKEND_RESERVED,
+                                     CATTLE_TAPE_BACKEND_SPARSE };
+    guint             i;
+
+    for (i = 0; i <= G_N_ELEMENTS (backends); i++)
+    {
+        g_autoptr (CattleTape) tape = NULL;
+        g_autoptr (CattleTape) snapshot = NULL;
+        gulong                 usage;
+
+        if (i < G_N_ELEMENTS (backends))
+        {
+            tape = cattle_tape_new_with_backend (backends[i]);
+        }
+        else
+        {
+            tape = cattle_tape_new_with_size (4 * STEPS);
+        }
+
+        cattle_tape_set_current_value (tape, 1);
+        cattle_tape_push_bookmark (tape);
+        cattle_tape_move_right_by (tape, 3 * STEPS);
+        cattle_tape_set_current_value (tape, 2);
+        cattle_tape_move_left_by (tape, STEPS);
+        cattle_tape_set_current_value (tape, 3);
+        usage = cattle_tape_get_memory_usage (tape);
+
+        snapshot = cattle_tape_snapshot (tape);
+
+        cattle_tape_reset (tape);
+        g_assert (cattle_tape_is_at_beginning (tape));
+        g_assert (cattle_tape_is_at_end (tape));
+        g_assert (!cattle_tape_pop_bookmark (tape));
+        g_assert_cmpint (cattle_tape_get_current_value (tape), ==, 0);
+        g_assert (cattle_tape_move_right_by (tape, 2 * STEPS));
+        g_assert_cmpint (cattle_tape_get_current_value (tape), ==, 0);
+        g_assert (cattle_tape_move_right_by (tape, STEPS));
+        g_assert_cmpint (cattle_tape_get_current_value (tape), ==, 0);
+
+        /* Sparse tapes free all pages instead */
+        if (cattle_tape_get_backend (tape) != CATTLE_TAPE_BACKEND_SPARSE)
+        {
+            g_assert_cmpuint (cattle_tape_get_memory_usage (tape), ==, usage);
+        }
+
+        /* Snapshots are not affected */
+        g_assert_cmpint (cattle_tape_get_current_value (snapshot), ==, 3);
+        g_assert (cattle_tape_pop_bookmark (snapshot));
+        g_assert_cmpint (cattle_tape_get_current_value (snapshot), ==, 1);
+
+        /* Resetting again, without snapshots around */
+        cattle_tape_set_current_value (tape, 4);
+        cattle_tape_reset (tape);
+        g_assert (cattle_tape_move_right_by (tape, 3 * STEPS));
+        g_assert_cmpint (cattle_tape_get_current_value (tape), ==, 0);
+    }
+}
+
+/**
+ * test_tape_huge_pages:
+ *
+ * Check tapes backed by huge pages, where available, work just like
+ * regular ones, and that huge pages are only used by reserved tapes.
+ */
+static void
+test_tape_huge_pages (void)
+{
+    g_autoptr (CattleTape) tape = NULL;
+    g_autoptr (CattleTape) copy = NULL;
+    g_autoptr (GError)     error = NULL;
+    gchar                 *filename;
+    gboolean               enabled;
+    gint                   fd;
+    gulong                 i;
+
+    tape = cattle_tape_new ();
+    cattle_tape_set_huge_pages_are_enabled (tape, TRUE);
+    g_assert (!cattle_tape_get_huge_pages_are_enabled (tape));
+
+    g_clear_object (&tape);
+    tape = cattle_tape_new_with_backend (CATTLE_TAPE_BACKEND_RESERVED);
+    cattle_tape_set_huge_pages_are_enabled (tape, TRUE);
+
+    /* Cross a few huge pages in both directions */
+    for (i = 0; i < 8; i++)
+    {
+        g_assert (cattle_tape_move_right_by (tape, STEPS * STEPS));
+        cattle_tape_set_current_value (tape, (gint8) i);
+    }
+    for (i = 0; i < 8; i++)
+    {
+        g_assert (cattle_tape_move_left_by (tape, 2 * STEPS * STEPS));
+        cattle_tape_set_current_value (tape, (gint8) -i);
+    }
+
+    for (i = 8; i > 0; i--)
+    {
+        g_assert_cmpint (cattle_tape_get_current_value (tape), ==, (gint8) -(i - 1));
+        g_assert (cattle_tape_move_right_by (tape, 2 * STEPS * STEPS));
+    }
+    g_assert (cattle_tape_is_at_end (tape));
+    g_assert_cmpint (cattle_tape_get_current_value (tape), ==, 7);
+
+    /* Huge pages can be disabled again */
+    cattle_tape_set_huge_pages_are_enabled (tape, FALSE);
+    g_assert (!cattle_tape_get_huge_pages_are_enabled (tape));
+    g_assert (cattle_tape_move_right_by (tape, STEPS));
+
+    /* Loading a tape doesn't change the setting */
+    fd = g_file_open_tmp ("cattle-tape-XXXXXX", &filename, NULL);
+    g_assert (fd >= 0);
+    g_close (fd, NULL);
+
+    g_assert (cattle_tape_save (tape, filename, &error));
+    g_assert_no_error (error);
+
+    copy = cattle_tape_new_with_backend (CATTLE_TAPE_BACKEND_RESERVED);
+    cattle_tape_set_huge_pages_are_enabled (copy, TRUE);
+    enabled = cattle_tape_get_huge_pages_are_enabled (copy);
+
+    g_assert (cattle_tape_load (copy, filename, &error));
+    g_assert_no_error (error);
+    g_assert_cmpint (cattle_tape_get_huge_pages_are_enabled (copy), ==, enabled);
+    g_assert (cattle_tape_move_right_by (copy, STEPS * STEPS));
+
+    g_unlink (filename);
+    g_free (filename);
+}
+
+/**
+ * test_tape_save_load:
+ *
+ * Save a tape to a file and load it back, with every backend.
+ */
+static void
+test_tape_save_load (void)
+{
+    CattleTapeBackend backends[] = {
+        CATTLE_TAPE_BACKEND_HEAP,
+        CATTLE_TAPE_BACKEND_RESERVED,
+        CATTLE_TAPE_BACKEND_SPARSE
+    };
+    g_autoptr (GError) error = NULL;
+    gchar             *filename;
+    gint               fd;
+    gulong             i;
+    gulong             j;
+
+    fd = g_file_open_tmp ("cattle-tape-XXXXXX", &filename, NULL);
+    g_assert (fd >= 0);
+    g_close (fd, NULL);
+
+    for (i = 0; i < G_N_ELEMENTS (backends); i++)
+    {
+        g_autoptr (CattleTape) tape = NULL;
+        g_autoptr (CattleTape) copy = NULL;
+
+        tape = cattle_tape_new_with_backend (backends[i]);
+        cattle_tape_set_left_growth_is_enabled (tape, TRUE);
+
+        /* Write a pattern on both sides of the origin and leave a
+         * couple of bookmarks around */
+        g_assert (cattle_tape_move_left_by (tape, STEPS));
+        for (j = 0; j < 2 * STEPS; j++)
+        {
+            cattle_tape_set_current_value (tape, (gint8) j);
+            if (j == 3 || j == STEPS)
+                cattle_tape_push_bookmark (tape);
+            g_assert (cattle_tape_move_right (tape));
+        }
+        g_assert (cattle_tape_move_left_by (tape, 5));
+
+        g_assert (cattle_tape_save (tape, filename, &error));
+        g_assert_no_error (error);
+
+        copy = cattle_tape_new_with_backend (backends[i]);
+        cattle_tape_set_left_growth_is_enabled (copy, TRUE);
+        g_assert (cattle_tape_load (copy, filename, &error));
+        g_assert_no_error (error);
+
+        /* Position and contents must match */
+        g_assert_cmpint (cattle_tape_get_current_value (copy), ==, (gint8) (2 * STEPS - 5));
+        g_assert (cattle_tape_pop_bookmark (copy));
+        g_assert_cmpint (cattle_tape_get_current_value (copy), ==, (gint8) STEPS);
+        g_assert (cattle_tape_pop_bookmark (copy));
+        g_assert_cmpint (cattle_tape_get_current_value (copy), ==, 3);
+        g_assert (!cattle_tape_pop_bookmark (copy));
+
+        g_assert (cattle_tape_move_left_by (copy, 3));
+        for (j = 0; j < 2 * STEPS; j++)
+        {
+            g_assert_cmpint (cattle_tape_get_current_value (copy), ==, (gint8) j);
+            g_assert (cattle_tape_move_right (copy));
+        }
+        g_assert (cattle_tape_is_at_end (copy));
+        g_assert_cmpint (cattle_tape_get_current_value (copy), ==, 0);
+
+        /* A loaded tape works like any other tape */
+        cattle_tape_increase_current_value (copy);
+        g_assert (cattle_tape_move_right (copy));
+        g_assert_cmpint (cattle_tape_get_current_value (copy), ==, 0);
+    }
+
+    /* Cell width is preserved, and must match the receiving tape */
+    {
+        g_autoptr (CattleTape) tape = NULL;
+        g_autoptr (CattleTape) copy = NULL;
+
+        tape = cattle_tape_new_with_cell_width (CATTLE_CELL_WIDTH_64);
+        cattle_tape_set_current_wide_value (tape, G_MAXINT64);
+        g_assert (cattle_tape_save (tape, filename, &error));
+        g_assert_no_error (error);
+
+        copy = cattle_tape_new ();
+        g_assert (!cattle_tape_load (copy, filename, &error));
+        g_assert_error (error, CATTLE_ERROR, CATTLE_ERROR_IO);
+        g_clear_error (&error);
+
+        g_clear_object (&copy);
+        copy = cattle_tape_new_with_cell_width (CATTLE_CELL_WIDTH_64);
+        g_assert (cattle_tape_load (copy, filename, &error));
+        g_assert_no_error (error);
+        g_assert_cmpint (cattle_tape_get_current_wide_value (copy), ==, G_MAXINT64);
+    }
+
+    /* A tape can be saved to the same file it was loaded from, and
+     * is not affected by the file being replaced */
+    {
+        g_autoptr (CattleTape) tape = NULL;
+        g_autoptr (CattleTape) copy = NULL;
+        g_autoptr (CattleTape) other = NULL;
+
+        tape = cattle_tape_new_with_backend (CATTLE_TAPE_BACKEND_RESERVED);
+        for (j = 0; j < 200000; j++)
+        {
+            cattle_tape_set_current_value (tape, (gint8) (j % 100));
+            g_assert (cattle_tape_move_right (tape));
+        }
+        g_assert (cattle_tape_save (tape, filename, &error));
+        g_assert_no_error (error);
+
+        copy = cattle_tape_new_with_backend (CATTLE_TAPE_BACKEND_RESERVED);
+        g_assert (cattle_tape_load (copy, filename, &error));
+        g_assert_no_error (error);
+        cattle_tape_increase_current_value (copy);
+        g_assert (cattle_tape_save (copy, filename, &error));
+        g_assert_no_error (error);
+
+        other = cattle_tape_new_with_backend (CATTLE_TAPE_BACKEND_RESERVED);
+        g_assert (cattle_tape_load (other, filename, &error));
+        g_assert_no_error (error);
+        g_assert_cmpint (cattle_tape_get_current_value (other), ==, 1);
+
+        /* Both tapes still see all of their cells */
+        g_assert (cattle_tape_move_left_by (copy, 200000));
+        g_assert (cattle_tape_move_left_by (other, 200000));
+        for (j = 0; j < 200000; j++)
+        {
+            g_assert_cmpint (cattle_tape_get_current_value (copy), ==, (gint8) (j % 100));
+            g_assert_cmpint (cattle_tape_get_current_value (other), ==, (gint8) (j % 100));
+            g_assert (cattle_tape_move_right (copy));
+            g_assert (cattle_tape_move_right (other));
+        }
+    }
+
+    /* Bookmarks pointing outside of the tape are rejected */
+    {
+        g_autoptr (CattleTape) tape = NULL;
+        g_autoptr (CattleTape) copy = NULL;
+        gint64                 bad[] = { 4, -1, G_MAXINT64, G_MININT64 };
+        gchar                 *contents;
+        gsize                  length;
+
+        /* Four cells, with a bookmark on the last one */
+        tape = cattle_tape_new ();
+        g_assert (cattle_tape_move_right_by (tape, 3));
+        cattle_tape_push_bookmark (tape);
+        g_assert (cattle_tape_move_left_by (tape, 3));
+        g_assert (cattle_tape_save (tape, filename, &error));
+        g_assert_no_error (error);
+
+        g_assert (g_file_get_contents (filename, &contents, &length, NULL));
+
+        /* The bookmark is stored right after the cells */
+        for (j = 0; j < G_N_ELEMENTS (bad); j++)
+        {
+            memcpy (contents + 4, &bad[j], sizeof (gint64));
+            g_assert (g_file_set_contents (filename, contents, length, NULL));
+
+            copy = cattle_tape_new ();
+            g_assert (!cattle_tape_load (copy, filename, &error));
+            g_assert_error (error, CATTLE_ERROR, CATTLE_ERROR_IO);
+            g_clear_error (&error);
+            g_clear_object (&copy);
+        }
+
+        g_free (contents);
+    }
+
+    /* Files that don't contain a tape are rejected */
+    {
+        g_autoptr (CattleTape) tape = NULL;
+
+        g_assert (g_file_set_contents (filename, "+[>+]", -1, NULL));
+
+        tape = cattle_tape_new ();
+        g_assert (!cattle_tape_load (tape, filename, &error));
+        g_assert_error (error, CATTLE_ERROR, CATTLE_ERROR_IO);
+        g_clear_error (&error);
+    }
+
+    g_unlink (filename);
+    g_free (filename);
+}
+
 gint
 main (gint argc, gchar **argv)
 {
@@ -385,6 +1500,8 @@ main (gint argc, gchar **argv)
                      test_tape_move_left);
     g_test_add_func ("/tape/bookmarks",
                      test_tape_bookmarks);
+    g_test_add_func ("/tape/nested-bookmarks",
+                     test_tape_nested_bookmarks);
     g_test_add_func ("/tape/current-value",
                      test_tape_current_value);
     g_test_add_func ("/tape/increase-current-value",
@@ -395,6 +1512,36 @@ main (gint argc, gchar **argv)
                      test_tape_positive_wrap);
     g_test_add_func ("/tape/negative-wrap",
                      test_tape_negative_wrap);
+    g_test_add_func ("/tape/reserve",
+                     test_tape_reserve);
+    g_test_add_func ("/tape/growth",
+                     test_tape_growth);
+    g_test_add_func ("/tape/fixed-size",
+                     test_tape_fixed_size);
+    g_test_add_func ("/tape/left-growth",
+                     test_tape_left_growth);
+    g_test_add_func ("/tape/reserved-backend",
+                     test_tape_reserved_backend);
+    g_test_add_func ("/tape/sparse-backend",
+                     test_tape_sparse_backend);
+    g_test_add_func ("/tape/cell-width",
+                     test_tape_cell_width);
+    g_test_add_func ("/tape/snapshot",
+                     test_tape_snapshot);
+    g_test_add_func ("/tape/snapshot-fork",
+                     test_tape_snapshot_fork);
+    g_test_add_func ("/tape/range",
+                     test_tape_range);
+    g_test_add_func ("/tape/range-edges",
+                     test_tape_range_edges);
+    g_test_add_func ("/tape/memory-limit",
+                     test_tape_memory_limit);
+    g_test_add_func ("/tape/reset",
+                     test_tape_reset);
+    g_test_add_func ("/tape/huge-pages",
+                     test_tape_huge_pages);
+    g_test_add_func ("/tape/save-load",
+                     test_tape_save_load);
 
     return g_test_run ();
 }